@@ -1,4 +1,4 @@
-QT       += core gui xml network
+QT       += core gui xml network concurrent
 
 greaterThan(QT_MAJOR_VERSION, 4): QT += widgets printsupport
 
@@ -48,24 +48,44 @@ SOURCES +=  \
     ../src/util/versiondownloader.cpp \
     ../src/dialogs/aboutdialog.cpp \
     ../src/customwidgets/legend.cpp \
-    ../src/customwidgets/legenditem.cpp \
+    ../src/customwidgets/legendmodel.cpp \
     ../src/customwidgets/markerinfo.cpp \
     ../src/customwidgets/markerinfoitem.cpp \
-    ../src/customwidgets/verticalscrollareacontents.cpp \
     ../src/models/graphdata.cpp \
     ../src/models/graphdatamodel.cpp \
     ../src/util/util.cpp \
     ../src/graphview/myqcustomplot.cpp \
     ../src/dialogs/markerinfodialog.cpp \
     ../src/graphview/myqcpaxis.cpp \
-    ../src/graphview/myqcpaxistickertime.cpp
+    ../src/graphview/myqcpaxistickertime.cpp \
+    ../src/graphview/myqcpgraph.cpp \
+    ../src/graphview/graphrasterizer.cpp \
+    ../src/graphview/asyncgraphrenderer.cpp \
+    ../src/graphview/framescheduler.cpp \
+    ../src/graphview/tilecache.cpp \
+    ../src/models/graphdataindex.cpp \
+    ../src/models/markerexpression.cpp \
+    ../src/models/expression.cpp \
+    ../src/models/graphfilter.cpp \
+    ../src/models/spectrum.cpp \
+    ../src/models/correlation.cpp \
+    ../src/models/correlationmodel.cpp \
+    ../src/models/eventsearch.cpp \
+    ../src/dialogs/markerstatisticsdialog.cpp \
+    ../src/dialogs/spectrumdialog.cpp \
+    ../src/dialogs/correlationdialog.cpp \
+    ../src/dialogs/eventsearchdialog.cpp
 
 FORMS    += \
     ../src/dialogs/axisscaledialog.ui \
     ../src/dialogs/loadfiledialog.ui \
     ../src/dialogs/mainwindow.ui \
     ../src/dialogs/aboutdialog.ui \
-    ../src/dialogs/markerinfodialog.ui
+    ../src/dialogs/markerinfodialog.ui \
+    ../src/dialogs/markerstatisticsdialog.ui \
+    ../src/dialogs/spectrumdialog.ui \
+    ../src/dialogs/correlationdialog.ui \
+    ../src/dialogs/eventsearchdialog.ui
 
 HEADERS += \
     ../libraries/qcustomplot/qcustomplot.h \
@@ -86,15 +106,31 @@ HEADERS += \
     ../src/util/versiondownloader.h \
     ../src/dialogs/aboutdialog.h \
     ../src/customwidgets/legend.h \
-    ../src/customwidgets/legenditem.h \
+    ../src/customwidgets/legendmodel.h \
     ../src/customwidgets/markerinfo.h \
     ../src/customwidgets/markerinfoitem.h \
-    ../src/customwidgets/verticalscrollareacontents.h \
     ../src/models/graphdatamodel.h \
     ../src/graphview/myqcustomplot.h \
     ../src/dialogs/markerinfodialog.h \
     ../src/graphview/myqcpaxis.h \
-    ../src/graphview/myqcpaxistickertime.h
+    ../src/graphview/myqcpaxistickertime.h \
+    ../src/graphview/myqcpgraph.h \
+    ../src/graphview/graphrasterizer.h \
+    ../src/graphview/asyncgraphrenderer.h \
+    ../src/graphview/framescheduler.h \
+    ../src/graphview/tilecache.h \
+    ../src/models/graphdataindex.h \
+    ../src/models/markerexpression.h \
+    ../src/models/expression.h \
+    ../src/models/graphfilter.h \
+    ../src/models/spectrum.h \
+    ../src/models/correlation.h \
+    ../src/models/correlationmodel.h \
+    ../src/models/eventsearch.h \
+    ../src/dialogs/markerstatisticsdialog.h \
+    ../src/dialogs/spectrumdialog.h \
+    ../src/dialogs/correlationdialog.h \
+    ../src/dialogs/eventsearchdialog.h
 
 RESOURCES += \
     ../resources/resource.qrc
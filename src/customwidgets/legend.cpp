@@ -1,26 +1,43 @@
 
 
-#include <QStyleOption>
-#include <QDebug>
-#include <QPainter>
-#include <QMouseEvent>
+#include <QInputDialog>
 
 #include "guimodel.h"
 #include "graphdatamodel.h"
-#include "util.h"
+#include "legendmodel.h"
 #include "legend.h"
 #include "basicgraphview.h"
 
 Legend::Legend(QWidget *parent) : QFrame(parent)
 {
+    _pGuiModel = NULL;
+    _pGraphDataModel = NULL;
+    _pLegendModel = NULL;
+    _pGraphView = NULL;
+    _popupMenuItem = -1;
+
     _pLayout = new QVBoxLayout();
 
     _pNoGraphs = new QLabel("No active graphs");
 
+    _pFilter = new QLineEdit();
+    _pFilter->setPlaceholderText("Filter");
+    _pFilter->setClearButtonEnabled(true);
+
+    _pListView = new QListView();
+    _pListView->setUniformItemSizes(true); // Rows are laid out without asking every row for its size
+    _pListView->setSelectionMode(QAbstractItemView::NoSelection);
+    _pListView->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    _pListView->setIconSize(QSize(10, 10));
+    _pListView->setFrameShape(QFrame::NoFrame);
+    _pListView->setContextMenuPolicy(Qt::CustomContextMenu);
+
     _pLayout->setSpacing(4);
     _pLayout->setContentsMargins(1, 1, 1, 1); // This is redundant with setMargin, which is deprecated
 
     _pLayout->addWidget(_pNoGraphs);
+    _pLayout->addWidget(_pFilter);
+    _pLayout->addWidget(_pListView);
     setLayout(_pLayout);
 
     // For rightclick menu
@@ -29,6 +46,12 @@ Legend::Legend(QWidget *parent) : QFrame(parent)
     _pToggleVisibilityAction = _pLegendMenu->addAction("Toggle item visibility");
     _pToggleVisibilityAction->setEnabled(false);
 
+    _pScalingAction = _pLegendMenu->addAction("Set gain and offset...");
+    _pScalingAction->setEnabled(false);
+
+    _pFilterAction = _pLegendMenu->addAction("Add filter...");
+    _pFilterAction->setEnabled(false);
+
     (void)_pLegendMenu->addSeparator();
     _pHideAllAction = _pLegendMenu->addAction("Hide all");
     _pHideAllAction->setEnabled(false);
@@ -37,11 +60,14 @@ Legend::Legend(QWidget *parent) : QFrame(parent)
     _pShowAllAction->setEnabled(false);
 
     connect(_pToggleVisibilityAction, &QAction::triggered, this, &Legend::toggleVisibilityClicked);
+    connect(_pScalingAction, &QAction::triggered, this, &Legend::scalingClicked);
+    connect(_pFilterAction, &QAction::triggered, this, &Legend::filterClicked);
     connect(_pHideAllAction, &QAction::triggered, this, &Legend::hideAll);
     connect(_pShowAllAction, &QAction::triggered, this, &Legend::showAll);
 
-    setContextMenuPolicy(Qt::CustomContextMenu);
-    connect(this, &Legend::customContextMenuRequested, this, &Legend::showContextMenu);
+    connect(_pListView, &QListView::clicked, this, &Legend::itemClicked);
+    connect(_pListView, &QListView::doubleClicked, this, &Legend::itemDoubleClicked);
+    connect(_pListView, &QListView::customContextMenuRequested, this, &Legend::showContextMenu);
 }
 
 Legend::~Legend()
@@ -59,83 +85,48 @@ void Legend::setModels(GuiModel *pGuiModel, GraphDataModel * pGraphDataModel)
     _pGuiModel = pGuiModel;
     _pGraphDataModel = pGraphDataModel;
 
+    _pLegendModel = new LegendModel(_pGraphDataModel, this);
+    _pListView->setModel(_pLegendModel);
+
+    connect(_pFilter, &QLineEdit::textChanged, _pLegendModel, &LegendModel::setFilter);
+
     connect(_pGraphDataModel, SIGNAL(activeChanged(quint32)), this, SLOT(updateLegend()));
     connect(_pGraphDataModel, SIGNAL(added(quint32)), this, SLOT(updateLegend()));
     connect(_pGraphDataModel, SIGNAL(removed(quint32)), this, SLOT(updateLegend()));
-    connect(_pGraphDataModel, SIGNAL(visibilityChanged(quint32)), this, SLOT(showGraph(const quint32)));
-    connect(_pGraphDataModel, SIGNAL(colorChanged(quint32)), this, SLOT(changeGraphColor(quint32)));
-    connect(_pGraphDataModel, SIGNAL(labelChanged(quint32)), this, SLOT(changeGraphLabel(quint32)));
-
-}
-
-void Legend::mousePressEvent(QMouseEvent * event)
-{
-    Q_UNUSED(event);
-
-    qint32 idx = itemUnderCursor();
-    if (idx != -1)
-    {
-        _pGuiModel->setFrontGraph(idx);
-    }
-}
+    connect(_pGraphDataModel, SIGNAL(graphListChanged()), this, SLOT(updateLegend()));
+    connect(_pGraphDataModel, SIGNAL(graphPropertiesChanged()), _pLegendModel, SLOT(updateAllGraphs()));
+    connect(_pGraphDataModel, SIGNAL(visibilityChanged(quint32)), _pLegendModel, SLOT(updateGraph(quint32)));
+    connect(_pGraphDataModel, SIGNAL(colorChanged(quint32)), _pLegendModel, SLOT(updateGraph(quint32)));
+    connect(_pGraphDataModel, SIGNAL(labelChanged(quint32)), _pLegendModel, SLOT(updateGraph(quint32)));
 
-void Legend::mouseDoubleClickEvent(QMouseEvent * event)
-{
-    Q_UNUSED(event);
-
-    const qint32 idx = itemUnderCursor();
-    toggleItemVisibility(idx);
+    updateLegend();
 }
 
 void Legend::updateDataInLegend()
 {
-    QStringList legendDataValues;
-
     /* Select correct values to show */
     if (_pGuiModel->cursorValues())
     {
-        updateCursorDataInLegend(legendDataValues);
+        QList<double> valueList;
+        const bool bInRange = _pGraphView->valuesUnderCursor(valueList);
+
+        _pLegendModel->setCursorValues(valueList, bInRange);
     }
     else
     {
-        for (qint32 i = 0; i < _items.size(); i++)
-        {
-            legendDataValues.append(QString(""));
-        }
-    }
-
-
-    if (_items.size() == legendDataValues.size())
-    {
-        for (qint32 i = 0; i < _items.size(); i++)
-        {
-            const qint32 graphIdx = _pGraphDataModel->convertToGraphIndex(i);
-            _items[i]->setText(QString("%1%2").arg(legendDataValues[i]).arg(_pGraphDataModel->label(graphIdx)));
-        }
+        _pLegendModel->clearCursorValues();
     }
 }
 
 void Legend::updateLegend()
 {
-    for(qint32 idx = 0; idx < _items.size(); idx++)
-    {
-        _pLayout->removeWidget(_items[idx]);
-        delete _items[idx];
-    }
-    _items.clear();
+    _pLegendModel->rebuild();
 
     if (_pGraphDataModel->activeCount() != 0)
     {
-        QList<quint16> activeList;
-
-        _pGraphDataModel->activeGraphIndexList(&activeList);
-
-        for (qint32 idx = 0; idx < activeList.size(); idx++)
-        {
-            addItem(activeList[idx]);
-        }
-
         _pNoGraphs->setVisible(false);
+        _pFilter->setVisible(true);
+        _pListView->setVisible(true);
 
         _pToggleVisibilityAction->setEnabled(true);
         _pHideAllAction->setEnabled(true);
@@ -144,6 +135,8 @@ void Legend::updateLegend()
     else
     {
         _pNoGraphs->setVisible(true);
+        _pFilter->setVisible(false);
+        _pListView->setVisible(false);
 
         _pToggleVisibilityAction->setEnabled(false);
         _pHideAllAction->setEnabled(false);
@@ -151,147 +144,143 @@ void Legend::updateLegend()
     }
 }
 
-void Legend::showGraph(quint32 graphIdx)
+void Legend::itemClicked(const QModelIndex &index)
 {
-    const qint32 activeGraphIdx = _pGraphDataModel->convertToActiveGraphIndex(graphIdx);
-
-    if (activeGraphIdx != -1)
+    const qint32 activeIdx = _pLegendModel->activeIndex(index.row());
+    if (activeIdx != -1)
     {
-        QFont font = _items[activeGraphIdx]->font();
-        QPalette palette = _items[activeGraphIdx]->palette();
-
-        if (_pGraphDataModel->isVisible(graphIdx))
-        {
-            font.setItalic(false);
-            palette.setColor(QPalette::WindowText,Qt::black);
-        }
-        else
-        {
-            font.setItalic(true);
-            palette.setColor(QPalette::WindowText,Qt::gray);
-        }
-
-        _items[activeGraphIdx]->setFont(font);
-        _items[activeGraphIdx]->setPalette(palette);
+        _pGuiModel->setFrontGraph(activeIdx);
     }
 }
 
-void Legend::changeGraphColor(const quint32 graphIdx)
+void Legend::itemDoubleClicked(const QModelIndex &index)
 {
-    const qint32 activeGraphIdx = _pGraphDataModel->convertToActiveGraphIndex(graphIdx);
-
-    if (activeGraphIdx != -1)
-    {
-        _items[activeGraphIdx]->setColor(_pGraphDataModel->color(graphIdx));
-    }
+    toggleItemVisibility(index.row());
 }
 
-void Legend::changeGraphLabel(const quint32 graphIdx)
+void Legend::toggleItemVisibility(qint32 row)
 {
-    const qint32 activeGraphIdx = _pGraphDataModel->convertToActiveGraphIndex(graphIdx);
+    const qint32 graphIdx = _pLegendModel->graphIndex(row);
 
-    if (activeGraphIdx != -1)
+    if (graphIdx != -1)
     {
-       _items[activeGraphIdx]->setText(_pGraphDataModel->label(graphIdx));
+        _pGraphDataModel->setVisible(graphIdx, !_pGraphDataModel->isVisible(graphIdx));
     }
 }
 
-void Legend::updateCursorDataInLegend(QStringList &cursorValueList)
+void Legend::showContextMenu(const QPoint& pos)
 {
-    QList<double> valueList;
-    const bool bInRange = _pGraphView->valuesUnderCursor(valueList);
-
-    cursorValueList.clear();
+    const QModelIndex index = _pListView->indexAt(pos);
+    _popupMenuItem = index.isValid() ? index.row() : -1;
 
-    for (qint32 i = 0; i < valueList.size(); i++)
+    if (_popupMenuItem == -1)
     {
-        if (bInRange)
-        {
-            // No error
-            cursorValueList.append(QString("[%1] ").arg(Util::formatDoubleForExport(valueList[i])));
-        }
-        else
-        {
-            /* Show error */
-            cursorValueList.append("[?] ");
-        }
+        _pToggleVisibilityAction->setEnabled(false);
+        _pScalingAction->setEnabled(false);
+        _pFilterAction->setEnabled(false);
     }
-}
+    else
+    {
+        _pToggleVisibilityAction->setEnabled(true);
+        _pScalingAction->setEnabled(true);
 
-void Legend::addItem(quint32 graphIdx)
-{
-    LegendItem * pNewItem = new LegendItem(this);
+        /* Filter graphs can't be filtered again */
+        _pFilterAction->setEnabled(!_pGraphDataModel->isFilter(_pLegendModel->graphIndex(_popupMenuItem)));
+    }
 
-    pNewItem->setText(_pGraphDataModel->label(graphIdx));
-    pNewItem->setColor(_pGraphDataModel->color(graphIdx));
+    _pLegendMenu->popup(_pListView->viewport()->mapToGlobal(pos));
+}
 
-    _items.append(pNewItem);
-    _pLayout->addWidget(pNewItem);
+void Legend::toggleVisibilityClicked()
+{
+    toggleItemVisibility(_popupMenuItem);
 }
 
-qint32 Legend::itemUnderCursor()
+/*!
+ * Ask gain and offset of graph, shown value is gain * sample + offset
+ */
+void Legend::scalingClicked()
 {
-    qint32 widgetIdx = -1;
+    const qint32 graphIdx = _pLegendModel->graphIndex(_popupMenuItem);
 
-    for (qint32 idx = 0u; idx < _items.size(); idx++)
+    if (graphIdx != -1)
     {
-        QRect widgetRect = _items[idx]->rect();
-        QPoint mousePos = _items[idx]->mapFromGlobal(QCursor::pos());
-        if(widgetRect.contains(mousePos))
+        const QString title = _pGraphDataModel->label(graphIdx);
+        bool bOk;
+
+        const double gain = QInputDialog::getDouble(this, title, "Gain:", _pGraphDataModel->gain(graphIdx), -1e12, 1e12, 6, &bOk);
+        if (!bOk)
         {
-            widgetIdx = idx;
-            break;
+            return;
         }
-    }
-
-    return widgetIdx;
-}
 
-void Legend::toggleItemVisibility(qint32 idx)
-{
-    if (idx != -1)
-    {
-        const qint32 graphIdx = _pGraphDataModel->convertToGraphIndex(idx);
+        const double offset = QInputDialog::getDouble(this, title, "Offset:", _pGraphDataModel->offset(graphIdx), -1e12, 1e12, 6, &bOk);
+        if (!bOk)
+        {
+            return;
+        }
 
-        _pGraphDataModel->setVisible(graphIdx, !_pGraphDataModel->isVisible(graphIdx));
+        _pGraphDataModel->setScaling(graphIdx, gain, offset);
     }
 }
 
-void Legend::showContextMenu(const QPoint& pos)
+/*!
+ * Ask type and length of filter, the filter is added as a new graph
+ */
+void Legend::filterClicked()
 {
-    _popupMenuItem = itemUnderCursor();
+    const qint32 graphIdx = _pLegendModel->graphIndex(_popupMenuItem);
 
-    if (_popupMenuItem == -1)
-    {
-        _pToggleVisibilityAction->setEnabled(false);
-    }
-    else
+    if (graphIdx != -1)
     {
-        _pToggleVisibilityAction->setEnabled(true);
-    }
+        const QString title = QString("Filter %1").arg(_pGraphDataModel->label(graphIdx));
+        bool bOk;
 
-    _pLegendMenu->popup(mapToGlobal(pos));
-}
+        QStringList typeList;
+        typeList.append(GraphFilter::typeName(GraphFilter::FILTER_MOVING_AVERAGE));
+        typeList.append(GraphFilter::typeName(GraphFilter::FILTER_LOW_PASS));
+        typeList.append(GraphFilter::typeName(GraphFilter::FILTER_MEDIAN));
+        typeList.append(GraphFilter::typeName(GraphFilter::FILTER_DERIVATIVE));
 
-void Legend::toggleVisibilityClicked()
-{
-    toggleItemVisibility(_popupMenuItem);
+        const QString typeName = QInputDialog::getItem(this, title, "Filter:", typeList, 0, false, &bOk);
+        if (!bOk)
+        {
+            return;
+        }
+
+        /* Window for moving average and median, time constant for low-pass, distance for derivative */
+        const qint32 length = QInputDialog::getInt(this, title, "Length (samples):", 10, 1, 1000000, 1, &bOk);
+        if (!bOk)
+        {
+            return;
+        }
+
+        _pGraphDataModel->addFilter(graphIdx, static_cast<GraphFilter::FilterType>(typeList.indexOf(typeName)), length);
+    }
 }
 
 void Legend::hideAll()
 {
-    for(qint32 idx = 0; idx < _pGraphDataModel->size(); idx++)
+    _pGraphDataModel->beginUpdate();
+
+    for(qint32 idx = 0; idx < _pGraphDataModel->activeCount(); idx++)
     {
         const qint32 graphIdx = _pGraphDataModel->convertToGraphIndex(idx);
         _pGraphDataModel->setVisible(graphIdx, false);
     }
+
+    _pGraphDataModel->endUpdate();
 }
 
 void Legend::showAll()
 {
-    for(qint32 idx = 0; idx < _pGraphDataModel->size(); idx++)
+    _pGraphDataModel->beginUpdate();
+
+    for(qint32 idx = 0; idx < _pGraphDataModel->activeCount(); idx++)
     {
         const qint32 graphIdx = _pGraphDataModel->convertToGraphIndex(idx);
         _pGraphDataModel->setVisible(graphIdx, true);
     }
+
+    _pGraphDataModel->endUpdate();
 }
@@ -4,14 +4,22 @@
 #include <QFrame>
 #include <QVBoxLayout>
 #include <QMenu>
-
-#include "legenditem.h"
+#include <QLabel>
+#include <QLineEdit>
+#include <QListView>
 
 /* Forward declaration */
 class GuiModel;
 class GraphDataModel;
 class BasicGraphView;
-
+class LegendModel;
+
+/*
+ * Legend with one row per active graph
+ *
+ * Rows are shown in a list view, so only rows on screen are painted, no
+ * widgets are created per graph. The name filter hides graphs that don't match.
+ * */
 class Legend : public QFrame
 {
     Q_OBJECT
@@ -22,9 +30,6 @@ public:
     void setModels(GuiModel *pGuiModel, GraphDataModel * pGraphDataModel);
     void setGraphview(BasicGraphView * pGraphView);
 
-    void mousePressEvent(QMouseEvent * event);
-    void mouseDoubleClickEvent(QMouseEvent * event);
-
 signals:
 
 public slots:
@@ -32,35 +37,37 @@ public slots:
 
 private slots:
     void updateLegend();
-    void showGraph(quint32 graphIdx);
-    void changeGraphColor(const quint32 graphIdx);
-    void changeGraphLabel(const quint32 graphIdx);
+    void itemClicked(const QModelIndex &index);
+    void itemDoubleClicked(const QModelIndex &index);
     void showContextMenu(const QPoint& pos);
     void toggleVisibilityClicked();
+    void scalingClicked();
+    void filterClicked();
     void hideAll();
     void showAll();
 
 private:
-    void updateCursorDataInLegend(QStringList &cursorValueList);
-    void addItem(quint32 graphIdx);
-    qint32 itemUnderCursor();
-    void toggleItemVisibility(qint32 idx);
+    void toggleItemVisibility(qint32 row);
 
     qint32 _popupMenuItem;
 
     // Models
     GuiModel * _pGuiModel;
     GraphDataModel * _pGraphDataModel;
+    LegendModel * _pLegendModel;
 
     BasicGraphView * _pGraphView;
 
     // Widgets
     QVBoxLayout * _pLayout;
     QLabel * _pNoGraphs;
-    QList<LegendItem *> _items;
+    QLineEdit * _pFilter;
+    QListView * _pListView;
 
     QMenu * _pLegendMenu;
     QAction * _pToggleVisibilityAction;
+    QAction * _pScalingAction;
+    QAction * _pFilterAction;
     QAction * _pHideAllAction;
     QAction * _pShowAllAction;
 };
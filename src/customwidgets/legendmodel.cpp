@@ -0,0 +1,312 @@
+
+#include <QFont>
+#include <QColor>
+
+#include "graphdatamodel.h"
+#include "util.h"
+#include "legendmodel.h"
+
+LegendModel::LegendModel(GraphDataModel * pGraphDataModel, QObject *parent) : QAbstractListModel(parent)
+{
+    _pGraphDataModel = pGraphDataModel;
+
+    _bCursorValues = false;
+    _bCursorInRange = false;
+}
+
+int LegendModel::rowCount(const QModelIndex &parent) const
+{
+    if (parent.isValid())
+    {
+        return 0;
+    }
+
+    return _rows.size();
+}
+
+QVariant LegendModel::data(const QModelIndex &index, int role) const
+{
+    if (
+        !index.isValid()
+        || (index.row() >= _rows.size())
+        )
+    {
+        return QVariant();
+    }
+
+    const qint32 activeIdx = _rows[index.row()];
+    const qint32 graphIdx = _activeGraphList[activeIdx];
+
+    switch (role)
+    {
+    case Qt::DisplayRole:
+        if (_bCursorValues && (activeIdx < _cursorValues.size()))
+        {
+            if (_bCursorInRange)
+            {
+                return QString("[%1] %2").arg(Util::formatDoubleForExport(_cursorValues[activeIdx])).arg(_pGraphDataModel->label(graphIdx));
+            }
+            else
+            {
+                /* Show error */
+                return QString("[?] %1").arg(_pGraphDataModel->label(graphIdx));
+            }
+        }
+        else
+        {
+            return _pGraphDataModel->label(graphIdx);
+        }
+
+    case Qt::DecorationRole:
+        return _pGraphDataModel->color(graphIdx);
+
+    case Qt::FontRole:
+        if (!_pGraphDataModel->isVisible(graphIdx))
+        {
+            QFont font;
+            font.setItalic(true);
+            return font;
+        }
+        break;
+
+    case Qt::ForegroundRole:
+        if (!_pGraphDataModel->derivedError(graphIdx).isEmpty())
+        {
+            /* Derived graph couldn't be calculated */
+            return QColor(Qt::red);
+        }
+        else if (!_pGraphDataModel->isVisible(graphIdx))
+        {
+            return QColor(Qt::gray);
+        }
+        break;
+
+    case Qt::ToolTipRole:
+        if (!_pGraphDataModel->derivedError(graphIdx).isEmpty())
+        {
+            return tr("Invalid expression: %1").arg(_pGraphDataModel->derivedError(graphIdx));
+        }
+        break;
+
+    default:
+        break;
+    }
+
+    return QVariant();
+}
+
+qint32 LegendModel::activeIndex(qint32 row) const
+{
+    if ((row >= 0) && (row < _rows.size()))
+    {
+        return _rows[row];
+    }
+
+    return -1;
+}
+
+qint32 LegendModel::graphIndex(qint32 row) const
+{
+    const qint32 activeIdx = activeIndex(row);
+
+    if (activeIdx != -1)
+    {
+        return _activeGraphList[activeIdx];
+    }
+
+    return -1;
+}
+
+/*!
+ * Only show graphs with a label that contains \a filter (case insensitive)
+ * When the filter is extended, only the rows that are shown are checked again
+ */
+void LegendModel::setFilter(const QString &filter)
+{
+    if (filter == _filter)
+    {
+        return;
+    }
+
+    beginResetModel();
+
+    if (filter.contains(_filter, Qt::CaseInsensitive))
+    {
+        /* Narrow down current rows */
+        QVector<qint32> rows;
+        foreach(qint32 activeIdx, _rows)
+        {
+            if (matchesFilter(activeIdx, filter))
+            {
+                rows.append(activeIdx);
+            }
+            else
+            {
+                _rowOfActive[activeIdx] = -1;
+            }
+        }
+
+        _rows = rows;
+    }
+    else
+    {
+        _rows.clear();
+        for (qint32 activeIdx = 0; activeIdx < _activeGraphList.size(); activeIdx++)
+        {
+            if (matchesFilter(activeIdx, filter))
+            {
+                _rows.append(activeIdx);
+            }
+        }
+
+        _rowOfActive.fill(-1, _activeGraphList.size());
+    }
+
+    for (qint32 row = 0; row < _rows.size(); row++)
+    {
+        _rowOfActive[_rows[row]] = row;
+    }
+
+    _filter = filter;
+
+    endResetModel();
+}
+
+/*!
+ * Store values under cursor (one per active graph), the view only formats rows that are on screen
+ */
+void LegendModel::setCursorValues(const QList<double> &valueList, bool bInRange)
+{
+    _cursorValues = valueList.toVector();
+    _bCursorInRange = bInRange;
+    _bCursorValues = true;
+
+    if (!_rows.isEmpty())
+    {
+        emit dataChanged(index(0), index(_rows.size() - 1), QVector<int>() << Qt::DisplayRole);
+    }
+}
+
+void LegendModel::clearCursorValues()
+{
+    if (_bCursorValues)
+    {
+        _bCursorValues = false;
+        _cursorValues.clear();
+
+        if (!_rows.isEmpty())
+        {
+            emit dataChanged(index(0), index(_rows.size() - 1), QVector<int>() << Qt::DisplayRole);
+        }
+    }
+}
+
+/*!
+ * Rebuild rows from active graphs of graph data model
+ */
+void LegendModel::rebuild()
+{
+    beginResetModel();
+
+    QList<quint16> activeList;
+    _pGraphDataModel->activeGraphIndexList(&activeList);
+
+    _activeGraphList.clear();
+    _activeGraphList.reserve(activeList.size());
+    foreach(quint16 graphIdx, activeList)
+    {
+        _activeGraphList.append(graphIdx);
+    }
+
+    _rows.clear();
+    _rowOfActive.fill(-1, _activeGraphList.size());
+
+    for (qint32 activeIdx = 0; activeIdx < _activeGraphList.size(); activeIdx++)
+    {
+        if (matchesFilter(activeIdx, _filter))
+        {
+            _rowOfActive[activeIdx] = _rows.size();
+            _rows.append(activeIdx);
+        }
+    }
+
+    _cursorValues.clear();
+    _bCursorValues = false;
+
+    endResetModel();
+}
+
+/*!
+ * Label, colour or visibility of graph has changed
+ */
+void LegendModel::updateGraph(const quint32 graphIdx)
+{
+    const qint32 activeIdx = _pGraphDataModel->convertToActiveGraphIndex(graphIdx);
+
+    if (
+        (activeIdx < 0)
+        || (activeIdx >= _rowOfActive.size())
+        )
+    {
+        return;
+    }
+
+    const bool bMatch = matchesFilter(activeIdx, _filter);
+    const qint32 row = _rowOfActive[activeIdx];
+
+    if (bMatch && (row != -1))
+    {
+        emit dataChanged(index(row), index(row));
+    }
+    else if (bMatch != (row != -1))
+    {
+        /* Label change moved graph in or out of filter */
+        rebuild();
+    }
+    else
+    {
+        // Not shown
+    }
+}
+
+/*!
+ * Label, colour or visibility of several graphs has changed (batch)
+ * The rows are only reset when a label change moved graphs in or out of the filter
+ */
+void LegendModel::updateAllGraphs()
+{
+    QVector<qint32> rows;
+    for (qint32 activeIdx = 0; activeIdx < _activeGraphList.size(); activeIdx++)
+    {
+        if (matchesFilter(activeIdx, _filter))
+        {
+            rows.append(activeIdx);
+        }
+    }
+
+    if (rows == _rows)
+    {
+        if (!_rows.isEmpty())
+        {
+            emit dataChanged(index(0), index(_rows.size() - 1));
+        }
+    }
+    else
+    {
+        beginResetModel();
+
+        _rows = rows;
+        _rowOfActive.fill(-1, _activeGraphList.size());
+        for (qint32 row = 0; row < _rows.size(); row++)
+        {
+            _rowOfActive[_rows[row]] = row;
+        }
+
+        endResetModel();
+    }
+}
+
+bool LegendModel::matchesFilter(qint32 activeIdx, const QString &filter) const
+{
+    return filter.isEmpty() || _pGraphDataModel->label(_activeGraphList[activeIdx]).contains(filter, Qt::CaseInsensitive);
+}
@@ -0,0 +1,54 @@
+#ifndef LEGENDMODEL_H
+#define LEGENDMODEL_H
+
+#include <QAbstractListModel>
+#include <QVector>
+
+/* Forward declaration */
+class GraphDataModel;
+
+/*
+ * List model with one row per active graph that matches the name filter
+ *
+ * Cursor values are stored as numbers, the text of a row is only formatted when
+ * the view requests it, so only rows that are on screen are formatted.
+ * */
+class LegendModel : public QAbstractListModel
+{
+    Q_OBJECT
+public:
+    explicit LegendModel(GraphDataModel * pGraphDataModel, QObject *parent = 0);
+
+    int rowCount(const QModelIndex &parent = QModelIndex()) const;
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const;
+
+    qint32 activeIndex(qint32 row) const;
+    qint32 graphIndex(qint32 row) const;
+
+    void setFilter(const QString &filter);
+    void setCursorValues(const QList<double> &valueList, bool bInRange);
+    void clearCursorValues();
+
+public slots:
+    void rebuild();
+    void updateGraph(const quint32 graphIdx);
+    void updateAllGraphs();
+
+private:
+    bool matchesFilter(qint32 activeIdx, const QString &filter) const;
+
+    GraphDataModel * _pGraphDataModel;
+
+    QVector<qint32> _activeGraphList; // graph index per active index
+    QVector<qint32> _rows; // active index per row
+    QVector<qint32> _rowOfActive; // row per active index, -1 when filtered
+
+    QString _filter;
+
+    QVector<double> _cursorValues; // per active index
+    bool _bCursorValues;
+    bool _bCursorInRange;
+
+};
+
+#endif // LEGENDMODEL_H
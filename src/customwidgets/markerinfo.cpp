@@ -6,6 +6,8 @@
 #include "markerinfoitem.h"
 #include "markerinfo.h"
 #include "markerinfodialog.h"
+#include "markerstatisticsdialog.h"
+#include "spectrumdialog.h"
 
 MarkerInfo::MarkerInfo(QWidget *parent) : QFrame(parent)
 {
@@ -30,6 +32,13 @@ MarkerInfo::MarkerInfo(QWidget *parent) : QFrame(parent)
     _pEditMarkerInfoMenu = new QMenu(parent);
     _pEditMarkerInfoAction = _pEditMarkerInfoMenu->addAction("Edit...");
     connect(_pEditMarkerInfoAction, &QAction::triggered, this, &MarkerInfo::showMarkerInfoDialog);
+    _pShowStatisticsAction = _pEditMarkerInfoMenu->addAction("Show all graphs...");
+    connect(_pShowStatisticsAction, &QAction::triggered, this, &MarkerInfo::showMarkerStatisticsDialog);
+    _pShowSpectrumAction = _pEditMarkerInfoMenu->addAction("Show spectrum...");
+    connect(_pShowSpectrumAction, &QAction::triggered, this, &MarkerInfo::showSpectrumDialog);
+
+    _pMarkerStatisticsDialog = NULL;
+    _pSpectrumDialog = NULL;
 
     setContextMenuPolicy(Qt::CustomContextMenu);
     connect(this, &MarkerInfo::customContextMenuRequested, this, &MarkerInfo::showContextMenu);
@@ -73,9 +82,33 @@ void MarkerInfo::showContextMenu(const QPoint& pos)
 
 void MarkerInfo::showMarkerInfoDialog()
 {
-    MarkerInfoDialog *pMarkerInfoDialog = new MarkerInfoDialog(_pGuiModel, this);
+    MarkerInfoDialog *pMarkerInfoDialog = new MarkerInfoDialog(_pGuiModel, _pGraphDataModel, this);
 
     pMarkerInfoDialog->exec();
 }
 
 
+
+void MarkerInfo::showMarkerStatisticsDialog()
+{
+    /* Dialog is kept to follow marker changes */
+    if (_pMarkerStatisticsDialog == NULL)
+    {
+        _pMarkerStatisticsDialog = new MarkerStatisticsDialog(_pGuiModel, _pGraphDataModel, this);
+    }
+
+    _pMarkerStatisticsDialog->show();
+    _pMarkerStatisticsDialog->raise();
+}
+
+void MarkerInfo::showSpectrumDialog()
+{
+    /* Dialog is kept with its settings, it follows marker changes while shown */
+    if (_pSpectrumDialog == NULL)
+    {
+        _pSpectrumDialog = new SpectrumDialog(_pGuiModel, _pGraphDataModel, this);
+    }
+
+    _pSpectrumDialog->show();
+    _pSpectrumDialog->raise();
+}
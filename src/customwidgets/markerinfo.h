@@ -12,6 +12,8 @@
 class GuiModel;
 class GraphDataModel;
 class MarkerInfoItem;
+class MarkerStatisticsDialog;
+class SpectrumDialog;
 
 class MarkerInfo : public QFrame
 {
@@ -31,6 +33,8 @@ private slots:
 	void updateMarkerData();
     void showContextMenu(const QPoint& pos);
     void showMarkerInfoDialog();
+    void showMarkerStatisticsDialog();
+    void showSpectrumDialog();
 
 private:
 
@@ -44,6 +48,11 @@ private:
 
     QMenu * _pEditMarkerInfoMenu;
     QAction * _pEditMarkerInfoAction;
+    QAction * _pShowStatisticsAction;
+    QAction * _pShowSpectrumAction;
+
+    MarkerStatisticsDialog * _pMarkerStatisticsDialog;
+    SpectrumDialog * _pSpectrumDialog;
     
     static const quint32 graphMarkerCount = 3;
 };
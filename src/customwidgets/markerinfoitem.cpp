@@ -1,8 +1,7 @@
 
-#include <limits>
-
 #include "guimodel.h"
 #include "graphdatamodel.h"
+#include "markerexpression.h"
 
 #include "util.h"
 #include "markerinfoitem.h"
@@ -47,8 +46,12 @@ void MarkerInfoItem::setModel(GuiModel * pGuiModel, GraphDataModel * pGraphDataM
     connect(_pGraphDataModel, SIGNAL(activeChanged(quint32)), this, SLOT(updateGraphList()));
     connect(_pGraphDataModel, SIGNAL(added(quint32)), this, SLOT(updateGraphList()));
     connect(_pGraphDataModel, SIGNAL(removed(quint32)), this, SLOT(removeFromGraphList(quint32)));
+    connect(_pGraphDataModel, SIGNAL(graphListChanged()), this, SLOT(updateGraphList()));
+    connect(_pGraphDataModel, SIGNAL(graphPropertiesChanged()), this, SLOT(updateGraphList()));
     connect(_pGraphDataModel, SIGNAL(colorChanged(quint32)), this, SLOT(updateColor(quint32)));
     connect(_pGraphDataModel, SIGNAL(labelChanged(quint32)), this, SLOT(updateLabel(quint32)));
+    connect(_pGraphDataModel, SIGNAL(scalingChanged(quint32)), this, SLOT(updateData()));
+    connect(_pGraphDataModel, SIGNAL(filterDataChanged()), this, SLOT(updateData()));
 
     connect(_pGuiModel, SIGNAL(startMarkerPosChanged()), this, SLOT(updateGraphList()));
     connect(_pGuiModel, SIGNAL(endMarkerPosChanged()), this, SLOT(updateGraphList()));
@@ -65,7 +68,10 @@ void MarkerInfoItem::updateData()
 
     if (graphIdx >= 0)
     {
-        QSharedPointer<QCPGraphDataContainer> dataMap = _pGraphDataModel->dataMap(graphIdx);
+        QCPRange markerRange(_pGuiModel->startMarkerPos(), _pGuiModel->endMarkerPos());
+        markerRange.normalize();
+
+        QSharedPointer<QCPGraphDataContainer> dataMap = _pGraphDataModel->dataMap(graphIdx, markerRange);
         QStringList expressionList;
         const quint32 mask = _pGuiModel->markerExpressionMask();
 
@@ -80,9 +86,14 @@ void MarkerInfoItem::updateData()
             }
         }
 
-        /* Add permanent items (y1, y2) */
-        expressionList.prepend(GuiModel::cMarkerExpressionEnd.arg(Util::formatDoubleForExport(dataMap->findBegin(_pGuiModel->endMarkerPos(), false)->value)));
-        expressionList.prepend(GuiModel::cMarkerExpressionStart.arg(Util::formatDoubleForExport(dataMap->findBegin(_pGuiModel->startMarkerPos(), false)->value)));
+        /* Add permanent items (y1, y2), graphs without samples are shown as placeholder */
+        const double placeholder = GraphDataModel::cPlaceholderValue;
+        const double gain = _pGraphDataModel->gain(graphIdx);
+        const double offset = _pGraphDataModel->offset(graphIdx);
+        const double endValue = gain * (dataMap->isEmpty() ? placeholder : dataMap->findBegin(_pGuiModel->endMarkerPos(), false)->value) + offset;
+        const double startValue = gain * (dataMap->isEmpty() ? placeholder : dataMap->findBegin(_pGuiModel->startMarkerPos(), false)->value) + offset;
+        expressionList.prepend(GuiModel::cMarkerExpressionEnd.arg(Util::formatDoubleForExport(endValue)));
+        expressionList.prepend(GuiModel::cMarkerExpressionStart.arg(Util::formatDoubleForExport(startValue)));
 
         /* Construct labels data */
         const qint32 leftRowCount = expressionList.size() - expressionList.size() / 2;
@@ -213,96 +224,45 @@ double MarkerInfoItem::calculateMarkerExpressionValue(quint32 expressionMask)
     double result = 0;
     const qint32 graphIdx = _pGraphCombo->currentData().toInt();
 
-    if (graphIdx >= 0)
-    {
-
-        QSharedPointer<QCPGraphDataContainer> pDataMap = _pGraphDataModel->dataMap(graphIdx);
-
-        const double valueDiff = pDataMap->findBegin(_pGuiModel->endMarkerPos(), false)->value - pDataMap->findBegin(_pGuiModel->startMarkerPos(), false)->value;
-        const double timeDiff = _pGuiModel->endMarkerPos() - _pGuiModel->startMarkerPos();
-
-        QCPGraphDataContainer::const_iterator dataPoint;
-        QCPGraphDataContainer::const_iterator start;
-        QCPGraphDataContainer::const_iterator end;
-
-        /* make sure we go in ascending order */
-        if (_pGuiModel->endMarkerPos() > _pGuiModel->startMarkerPos())
-        {
-            start = pDataMap->findBegin(_pGuiModel->startMarkerPos(), false);
-            end = pDataMap->findEnd(_pGuiModel->endMarkerPos(), false);
-        }
-        else
-        {
-            /* Change order */
-            start = pDataMap->findBegin(_pGuiModel->endMarkerPos());
-            end = pDataMap->findEnd(_pGuiModel->startMarkerPos());
-        }
-
+    QCPRange markerRange(_pGuiModel->startMarkerPos(), _pGuiModel->endMarkerPos());
+    markerRange.normalize();
 
-        if (expressionMask == GuiModel::cDifferenceMask)
-        {
-            result = valueDiff;
-        }
-        else if (expressionMask == GuiModel::cSlopeMask)
-        {
-            result = valueDiff / (timeDiff / 1000); // per second, TODO: round?
-        }
-        else if (expressionMask == GuiModel::cAverageMask)
-        {
-            double avg = 0;
-            quint32 count = 0;
-            for (dataPoint = start; dataPoint != end; dataPoint++)
-            {
-                count++;
-                avg += dataPoint->value;
-            }
+    if ((graphIdx >= 0) && (expressionMask == GuiModel::cCustomMask))
+    {
+        Expression expression;
 
-            if (count == 0)
-            {
-                result = 0;
-            }
-            else
-            {
-                result = avg / count;
-            }
-        }
-        else if (expressionMask == GuiModel::cMinimumMask)
+        if (expression.compile(_pGuiModel->markerExpressionCustomScript(), _pGraphDataModel->labelList()))
         {
-            double min = std::numeric_limits<double>::max();
-
-            for (dataPoint = start; dataPoint != end; dataPoint++)
+            QVector<Expression::Input> inputs;
+            foreach(qint32 refIdx, expression.references())
             {
-                if (dataPoint->value < min)
-                {
-                    min = dataPoint->value;
-                }
-            }
+                /* y is the selected graph */
+                const qint32 inputIdx = refIdx == Expression::cSelfReference ? graphIdx : refIdx;
 
-            result = min;
-        }
-        else if (expressionMask == GuiModel::cMaximumMask)
-        {
-            double max = std::numeric_limits<double>::lowest();
+                Expression::Input input;
+                input.pDataMap = _pGraphDataModel->dataMap(inputIdx, markerRange).data();
+                input.gain = _pGraphDataModel->gain(inputIdx);
+                input.offset = _pGraphDataModel->offset(inputIdx);
 
-            for (dataPoint = start; dataPoint != end; dataPoint++)
-            {
-                if (dataPoint->value > max)
-                {
-                    max = dataPoint->value;
-                }
+                inputs.append(input);
             }
 
-            result = max;
-        }
-        else if (expressionMask == GuiModel::cCustomMask)
-        {
-            /* TODO: call python script */
-        }
-        else
-        {
-            result = 0;
+            result = MarkerExpression::calculateCustom(expression, inputs,
+                                                       _pGraphDataModel->dataMap(graphIdx),
+                                                       _pGuiModel->startMarkerPos(),
+                                                       _pGuiModel->endMarkerPos());
         }
     }
+    else if (graphIdx >= 0)
+    {
+        result = MarkerExpression::calculate(_pGraphDataModel->dataMap(graphIdx),
+                                             _pGraphDataModel->dataIndex(graphIdx),
+                                             _pGuiModel->startMarkerPos(),
+                                             _pGuiModel->endMarkerPos(),
+                                             expressionMask,
+                                             _pGraphDataModel->gain(graphIdx),
+                                             _pGraphDataModel->offset(graphIdx));
+    }
 
     return result;
 }
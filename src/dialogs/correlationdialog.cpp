@@ -0,0 +1,266 @@
+#include <QtConcurrent>
+#include <QHeaderView>
+
+#include "guimodel.h"
+#include "graphdatamodel.h"
+#include "correlationmodel.h"
+
+#include "correlationdialog.h"
+#include "ui_correlationdialog.h"
+
+CorrelationDialog::CorrelationDialog(GuiModel *pGuiModel, GraphDataModel * pGraphDataModel, QWidget *parent) :
+    QDialog(parent),
+    _pUi(new Ui::CorrelationDialog)
+{
+    _pUi->setupUi(this);
+
+    /* Disable question mark button */
+    setWindowFlags(windowFlags() & ~Qt::WindowContextHelpButtonHint);
+
+    _pGuiModel = pGuiModel;
+    _pGraphDataModel = pGraphDataModel;
+
+    _generation.store(0);
+    _runningGeneration = 0;
+    _bPending = false;
+    _bOutdated = false;
+
+    _pUi->comboRange->addItem(tr("Between markers"));
+    _pUi->comboRange->addItem(tr("Full range"));
+
+    /* Fixed cell size, so the view doesn't measure all cells of a large matrix */
+    _pCorrelationModel = new CorrelationModel(_pGraphDataModel, this);
+    _pUi->tableCorrelation->setModel(_pCorrelationModel);
+    _pUi->tableCorrelation->horizontalHeader()->setDefaultSectionSize(_cCellSize);
+    _pUi->tableCorrelation->horizontalHeader()->setSectionResizeMode(QHeaderView::Fixed);
+    _pUi->tableCorrelation->verticalHeader()->setSectionResizeMode(QHeaderView::Fixed);
+
+    connect(&_correlationWatcher, &QFutureWatcher<Correlation::Result>::finished, this, &CorrelationDialog::correlationFinished);
+    connect(_pUi->tableCorrelation, &QTableView::doubleClicked, this, &CorrelationDialog::showGraphPair);
+
+    /* Graph list changes */
+    connect(_pGraphDataModel, SIGNAL(activeChanged(quint32)), this, SLOT(requestCorrelation()));
+    connect(_pGraphDataModel, SIGNAL(added(quint32)), this, SLOT(requestCorrelation()));
+    connect(_pGraphDataModel, SIGNAL(removed(quint32)), this, SLOT(requestCorrelation()));
+    connect(_pGraphDataModel, SIGNAL(graphListChanged()), this, SLOT(requestCorrelation()));
+    connect(_pGraphDataModel, SIGNAL(scalingChanged(quint32)), this, SLOT(requestCorrelation()));
+
+    /* Only headers change */
+    connect(_pGraphDataModel, SIGNAL(labelChanged(quint32)), _pCorrelationModel, SLOT(updateHeaders()));
+    connect(_pGraphDataModel, SIGNAL(colorChanged(quint32)), _pCorrelationModel, SLOT(updateHeaders()));
+    connect(_pGraphDataModel, SIGNAL(graphPropertiesChanged()), _pCorrelationModel, SLOT(updateHeaders()));
+
+    /* Range changes */
+    connect(_pGuiModel, SIGNAL(startMarkerPosChanged()), this, SLOT(requestMarkerCorrelation()));
+    connect(_pGuiModel, SIGNAL(endMarkerPosChanged()), this, SLOT(requestMarkerCorrelation()));
+    connect(_pGuiModel, SIGNAL(markerStateChanged()), this, SLOT(requestMarkerCorrelation()));
+    connect(_pUi->comboRange, SIGNAL(currentIndexChanged(int)), this, SLOT(requestCorrelation()));
+
+    requestCorrelation();
+}
+
+CorrelationDialog::~CorrelationDialog()
+{
+    /* Stop running calculation */
+    _generation.fetchAndAddOrdered(1);
+    _correlationWatcher.waitForFinished();
+
+    delete _pUi;
+}
+
+void CorrelationDialog::showEvent(QShowEvent * event)
+{
+    QDialog::showEvent(event);
+
+    if (_bOutdated)
+    {
+        requestCorrelation();
+    }
+}
+
+void CorrelationDialog::hideEvent(QHideEvent * event)
+{
+    QDialog::hideEvent(event);
+
+    /* Stop running calculation, result isn't shown anyway */
+    _generation.fetchAndAddOrdered(1);
+    _bPending = false;
+    _bOutdated = true;
+}
+
+void CorrelationDialog::requestCorrelation()
+{
+    /* Outdates running calculation */
+    const qint32 generation = _generation.fetchAndAddOrdered(1) + 1;
+
+    if (!isVisible())
+    {
+        _bPending = false;
+        _bOutdated = true;
+        return;
+    }
+
+    _bOutdated = false;
+
+    Request request;
+    _pGraphDataModel->activeGraphIndexList(&request.graphList);
+
+    if (isMarkerRange())
+    {
+        if (!_pGuiModel->markerState())
+        {
+            _bPending = false;
+
+            _pCorrelationModel->clear();
+            _pUi->labelStatus->setText(tr("Set start and end marker or select the full range"));
+
+            return;
+        }
+
+        request.keyRange = QCPRange(_pGuiModel->startMarkerPos(), _pGuiModel->endMarkerPos());
+        request.keyRange.normalize();
+    }
+    else
+    {
+        request.keyRange = QCPRange(-QCPRange::maxRange, QCPRange::maxRange);
+    }
+
+    foreach(quint16 graphIdx, request.graphList)
+    {
+        Correlation::Input input;
+        input.pDataMap = _pGraphDataModel->dataMap(graphIdx, request.keyRange).data();
+        input.pDataIndex = _pGraphDataModel->dataIndex(graphIdx).data();
+        input.revision = input.pDataIndex->revision();
+        input.gain = _pGraphDataModel->gain(graphIdx);
+        input.offset = _pGraphDataModel->offset(graphIdx);
+
+        request.dataMapList.append(_pGraphDataModel->dataMap(graphIdx));
+        request.dataIndexList.append(_pGraphDataModel->dataIndex(graphIdx));
+        request.inputs.append(input);
+    }
+
+    request.generation = generation;
+
+    if (_correlationWatcher.isRunning())
+    {
+        /* Only keep most recent request */
+        _pendingRequest = request;
+        _bPending = true;
+    }
+    else
+    {
+        startRequest(request);
+    }
+}
+
+void CorrelationDialog::requestMarkerCorrelation()
+{
+    if (isMarkerRange())
+    {
+        requestCorrelation();
+    }
+}
+
+void CorrelationDialog::correlationFinished()
+{
+    const Correlation::Result result = _correlationWatcher.result();
+    const bool bCurrent = _runningGeneration == _generation.load();
+    const QList<quint16> graphList = _runningGraphList;
+
+    if (_bPending)
+    {
+        _bPending = false;
+        startRequest(_pendingRequest);
+    }
+
+    if (!bCurrent)
+    {
+        /* Calculation is outdated */
+    }
+    else if (!result.bValid)
+    {
+        /* Samples were modified during the calculation */
+        requestCorrelation();
+    }
+    else
+    {
+        _pCorrelationModel->setCorrelation(graphList, result);
+
+        _pUi->labelStatus->setText(tr("%1 graphs, %2 samples. Double-click a cell to only show both graphs.")
+                                   .arg(result.columnCount)
+                                   .arg(result.sampleCount));
+    }
+}
+
+/*!
+ * Only show the graphs of the row and column of \a index
+ */
+void CorrelationDialog::showGraphPair(const QModelIndex &index)
+{
+    const qint32 rowGraphIdx = _pCorrelationModel->graphIndex(index.row());
+    const qint32 columnGraphIdx = _pCorrelationModel->graphIndex(index.column());
+
+    if ((rowGraphIdx == -1) || (columnGraphIdx == -1))
+    {
+        return;
+    }
+
+    QList<quint16> activeGraphList;
+    _pGraphDataModel->activeGraphIndexList(&activeGraphList);
+
+    _pGraphDataModel->beginUpdate();
+
+    foreach(quint16 graphIdx, activeGraphList)
+    {
+        _pGraphDataModel->setVisible(graphIdx, (graphIdx == rowGraphIdx) || (graphIdx == columnGraphIdx));
+    }
+
+    _pGraphDataModel->endUpdate();
+}
+
+void CorrelationDialog::startRequest(const Request &request)
+{
+    _pUi->labelStatus->setText(tr("Calculating..."));
+
+    _runningGeneration = request.generation;
+    _runningGraphList = request.graphList;
+
+    _correlationWatcher.setFuture(QtConcurrent::run(CorrelationDialog::calculate, request, _pGraphDataModel->dataLock(), &_generation));
+}
+
+bool CorrelationDialog::isMarkerRange()
+{
+    return _pUi->comboRange->currentIndex() == 0;
+}
+
+/*!
+ * Runs on worker thread: find sample range and calculate correlation
+ * The data lock is only held while samples are read, so the samples don't have to be copied
+ */
+Correlation::Result CorrelationDialog::calculate(Request request, QReadWriteLock * pDataLock, const QAtomicInt * pGeneration)
+{
+    QReadLocker locker(pDataLock);
+
+    /* All graphs share their keys, the longest graph has all of them */
+    const QCPGraphDataContainer * pKeyMap = NULL;
+    foreach(const Correlation::Input &input, request.inputs)
+    {
+        if ((pKeyMap == NULL) || (input.pDataMap->size() > pKeyMap->size()))
+        {
+            pKeyMap = input.pDataMap;
+        }
+    }
+
+    qint32 beginIdx = 0;
+    qint32 endIdx = 0;
+    if (pKeyMap != NULL)
+    {
+        beginIdx = pKeyMap->findBegin(request.keyRange.lower, false) - pKeyMap->constBegin();
+        endIdx = pKeyMap->findEnd(request.keyRange.upper, false) - pKeyMap->constBegin();
+    }
+
+    locker.unlock();
+
+    /* Correlation checks whether samples were modified since the sample range was found */
+    return Correlation::calculate(request.inputs, beginIdx, endIdx, pDataLock, pGeneration, request.generation);
+}
@@ -0,0 +1,81 @@
+#ifndef CORRELATIONDIALOG_H
+#define CORRELATIONDIALOG_H
+
+#include <QDialog>
+#include <QFutureWatcher>
+#include <QAtomicInt>
+#include "qcustomplot.h"
+#include "correlation.h"
+
+/* Forward declarations */
+class GuiModel;
+class GraphDataModel;
+class CorrelationModel;
+
+namespace Ui {
+class CorrelationDialog;
+}
+
+/*
+ * Correlation matrix of all active graphs, between the markers or over the full range
+ *
+ * The matrix is calculated on a worker thread, like the spectrum: every request increments the generation,
+ * so a running calculation stops as soon as it is outdated and only the most recent request is kept.
+ * Nothing is calculated while the dialog is hidden, changes in the meantime are handled when it is shown again.
+ * When samples are modified during a calculation, the correlation is requested again.
+ * Double-clicking a cell only shows the two graphs of that cell.
+ * */
+class CorrelationDialog : public QDialog
+{
+    Q_OBJECT
+
+public:
+    explicit CorrelationDialog(GuiModel *pGuiModel, GraphDataModel * pGraphDataModel, QWidget *parent = 0);
+    ~CorrelationDialog();
+
+protected:
+    void showEvent(QShowEvent * event);
+    void hideEvent(QHideEvent * event);
+
+private slots:
+    void requestCorrelation();
+    void requestMarkerCorrelation();
+    void correlationFinished();
+    void showGraphPair(const QModelIndex &index);
+
+private:
+
+    typedef struct
+    {
+        QList<quint16> graphList;
+        QList<QSharedPointer<QCPGraphDataContainer> > dataMapList; // Keeps containers of inputs alive
+        QList<QSharedPointer<GraphDataIndex> > dataIndexList; // Keeps indexes of inputs alive
+        QVector<Correlation::Input> inputs;
+        QCPRange keyRange;
+        qint32 generation;
+
+    } Request;
+
+    void startRequest(const Request &request);
+    bool isMarkerRange();
+    static Correlation::Result calculate(Request request, QReadWriteLock * pDataLock, const QAtomicInt * pGeneration);
+
+    Ui::CorrelationDialog * _pUi;
+
+    GuiModel * _pGuiModel;
+    GraphDataModel * _pGraphDataModel;
+    CorrelationModel * _pCorrelationModel;
+
+    QFutureWatcher<Correlation::Result> _correlationWatcher;
+    QAtomicInt _generation;
+    qint32 _runningGeneration;
+    QList<quint16> _runningGraphList;
+
+    Request _pendingRequest;
+    bool _bPending;
+    bool _bOutdated; // Changes while hidden, correlation is requested when shown
+
+    static const qint32 _cCellSize = 48; // in pixels
+};
+
+#endif // CORRELATIONDIALOG_H
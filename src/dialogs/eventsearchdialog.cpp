@@ -0,0 +1,111 @@
+#include "graphdatamodel.h"
+#include "basicgraphview.h"
+
+#include "eventsearchdialog.h"
+#include "ui_eventsearchdialog.h"
+
+EventSearchDialog::EventSearchDialog(GraphDataModel * pGraphDataModel, BasicGraphView * pGraphView, QWidget *parent) :
+    QDialog(parent),
+    _pUi(new Ui::EventSearchDialog)
+{
+    _pUi->setupUi(this);
+
+    /* Disable question mark button */
+    setWindowFlags(windowFlags() & ~Qt::WindowContextHelpButtonHint);
+
+    _pGraphDataModel = pGraphDataModel;
+    _pGraphView = pGraphView;
+
+    for (qint32 type = 0; type < EventSearch::SEARCH_TYPE_COUNT; type++)
+    {
+        _pUi->comboType->addItem(EventSearch::typeName(static_cast<EventSearch::SearchType>(type)), type);
+    }
+
+    connect(_pUi->comboType, SIGNAL(currentIndexChanged(int)), this, SLOT(updateValueInput()));
+    connect(_pUi->btnSearch, SIGNAL(clicked()), this, SLOT(search()));
+    connect(_pUi->btnPrevious, SIGNAL(clicked()), _pGraphView, SLOT(showPreviousEvent()));
+    connect(_pUi->btnNext, SIGNAL(clicked()), _pGraphView, SLOT(showNextEvent()));
+    connect(_pGraphView, SIGNAL(eventChanged()), this, SLOT(updateStatus()));
+
+    /* Graph list changes */
+    connect(_pGraphDataModel, SIGNAL(activeChanged(quint32)), this, SLOT(updateGraphList()));
+    connect(_pGraphDataModel, SIGNAL(added(quint32)), this, SLOT(updateGraphList()));
+    connect(_pGraphDataModel, SIGNAL(removed(quint32)), this, SLOT(updateGraphList()));
+    connect(_pGraphDataModel, SIGNAL(labelChanged(quint32)), this, SLOT(updateGraphList()));
+    connect(_pGraphDataModel, SIGNAL(graphListChanged()), this, SLOT(updateGraphList()));
+    connect(_pGraphDataModel, SIGNAL(graphPropertiesChanged()), this, SLOT(updateGraphList()));
+
+    updateGraphList();
+    updateValueInput();
+    updateStatus();
+}
+
+EventSearchDialog::~EventSearchDialog()
+{
+    delete _pUi;
+}
+
+void EventSearchDialog::updateGraphList()
+{
+    const qint32 selectedIdx = _pUi->comboGraph->currentData().toInt();
+
+    QList<quint16> activeGraphList;
+    _pGraphDataModel->activeGraphIndexList(&activeGraphList);
+
+    _pUi->comboGraph->blockSignals(true);
+    _pUi->comboGraph->clear();
+
+    foreach(quint16 graphIdx, activeGraphList)
+    {
+        QPixmap pixmap(20,5);
+        pixmap.fill(_pGraphDataModel->color(graphIdx));
+
+        _pUi->comboGraph->addItem(QIcon(pixmap), _pGraphDataModel->label(graphIdx), QVariant(graphIdx));
+    }
+
+    const qint32 comboIdx = _pUi->comboGraph->findData(selectedIdx);
+    _pUi->comboGraph->setCurrentIndex(comboIdx != -1 ? comboIdx : 0);
+    _pUi->comboGraph->blockSignals(false);
+
+    _pUi->btnSearch->setEnabled(_pUi->comboGraph->count() > 0);
+}
+
+void EventSearchDialog::updateValueInput()
+{
+    _pUi->spinValue->setEnabled(_pUi->comboType->currentData().toInt() != EventSearch::SEARCH_NAN);
+}
+
+void EventSearchDialog::search()
+{
+    if (_pUi->comboGraph->count() > 0)
+    {
+        const quint32 graphIdx = _pUi->comboGraph->currentData().toUInt();
+        const EventSearch::SearchType type = static_cast<EventSearch::SearchType>(_pUi->comboType->currentData().toInt());
+
+        if (_pGraphView->searchEvents(graphIdx, type, _pUi->spinValue->value()) > 0)
+        {
+            _pGraphView->showNextEvent();
+        }
+    }
+}
+
+void EventSearchDialog::updateStatus()
+{
+    const qint32 eventCount = _pGraphView->eventCount();
+    const qint32 currentEvent = _pGraphView->currentEvent();
+
+    _pUi->btnPrevious->setEnabled(currentEvent > 0);
+    _pUi->btnNext->setEnabled(currentEvent < eventCount - 1);
+
+    if (eventCount == 0)
+    {
+        _pUi->labelStatus->setText(tr("No events"));
+    }
+    else
+    {
+        _pUi->labelStatus->setText(tr("Event %1 of %2%3")
+                                   .arg(currentEvent + 1)
+                                   .arg(eventCount)
+                                   .arg(_pGraphView->eventsTruncated() ? tr(" (search stopped)") : QString()));
+    }
+}
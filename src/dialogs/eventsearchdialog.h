@@ -0,0 +1,42 @@
+#ifndef EVENTSEARCHDIALOG_H
+#define EVENTSEARCHDIALOG_H
+
+#include <QDialog>
+
+/* Forward declarations */
+class GraphDataModel;
+class BasicGraphView;
+
+namespace Ui {
+class EventSearchDialog;
+}
+
+/*
+ * Search events in a graph and step through them
+ *
+ * The search and navigation are done by the graph view, so next and previous event
+ * can also be shown with the menu shortcuts when the dialog is closed.
+ * */
+class EventSearchDialog : public QDialog
+{
+    Q_OBJECT
+
+public:
+    explicit EventSearchDialog(GraphDataModel * pGraphDataModel, BasicGraphView * pGraphView, QWidget *parent = 0);
+    ~EventSearchDialog();
+
+private slots:
+    void updateGraphList();
+    void updateValueInput();
+    void search();
+    void updateStatus();
+
+private:
+
+    Ui::EventSearchDialog * _pUi;
+
+    GraphDataModel * _pGraphDataModel;
+    BasicGraphView * _pGraphView;
+};
+
+#endif // EVENTSEARCHDIALOG_H
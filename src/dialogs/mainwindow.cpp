@@ -17,7 +17,10 @@
 #include "legend.h"
 #include "datafileparser.h"
 #include "loadfiledialog.h"
+#include "correlationdialog.h"
+#include "eventsearchdialog.h"
 #include <QDateTime>
+#include <QInputDialog>
 
 MainWindow::MainWindow(QStringList cmdArguments, QWidget *parent) :
     QMainWindow(parent),
@@ -39,6 +42,9 @@ MainWindow::MainWindow(QStringList cmdArguments, QWidget *parent) :
     _pLoadDataFileDialog = new LoadFileDialog(_pGuiModel, _pParserModel, this);
     connect(_pLoadDataFileDialog, SIGNAL(accepted()), this, SLOT(loadDataFileAccepted()));
 
+    _pCorrelationDialog = NULL;
+    _pEventSearchDialog = NULL;
+
     /* Add slot for file watcher */
     connect(_pWatchFile, SIGNAL(fileDataChanged()), this, SLOT(updateData()));
 
@@ -56,16 +62,26 @@ MainWindow::MainWindow(QStringList cmdArguments, QWidget *parent) :
     connect(_pUi->actionSetManualScaleYAxis, SIGNAL(triggered()), this, SLOT(showYAxisScaleDialog()));
     connect(_pUi->actionAutoScaleXAxis, SIGNAL(triggered()), _pGraphView, SLOT(autoScaleXAxis()));
     connect(_pUi->actionAutoScaleYAxis, SIGNAL(triggered()), _pGraphView, SLOT(autoScaleYAxis()));
+    connect(_pUi->actionWindowAutoScaleYAxis, SIGNAL(triggered()), this, SLOT(windowAutoScaleYAxis()));
+    connect(_pUi->actionSlidingScaleXAxis, SIGNAL(triggered()), this, SLOT(slidingScaleXAxis()));
     connect(_pUi->actionHighlightSamplePoints, SIGNAL(toggled(bool)), _pGuiModel, SLOT(setHighlightSamples(bool)));
+    connect(_pUi->actionDensityMode, SIGNAL(toggled(bool)), _pGuiModel, SLOT(setDensityMode(bool)));
     connect(_pUi->actionClearMarkers, SIGNAL(triggered()), _pGuiModel, SLOT(clearMarkersState()));
     connect(_pUi->actionWatchFile, SIGNAL(toggled(bool)), _pGuiModel, SLOT(setWatchFile(bool)));
     connect(_pUi->actionDynamicSession, SIGNAL(toggled(bool)), _pParserModel, SLOT(setDynamicSession(bool)));
+    connect(_pUi->actionAddDerivedGraph, SIGNAL(triggered()), this, SLOT(addDerivedGraph()));
+    connect(_pUi->actionShowCorrelation, SIGNAL(triggered()), this, SLOT(showCorrelationDialog()));
+    connect(_pUi->actionFindEvent, SIGNAL(triggered()), this, SLOT(showEventSearchDialog()));
+    connect(_pUi->actionNextEvent, SIGNAL(triggered()), _pGraphView, SLOT(showNextEvent()));
+    connect(_pUi->actionPreviousEvent, SIGNAL(triggered()), _pGraphView, SLOT(showPreviousEvent()));
 
     /*-- connect model to view --*/
     connect(_pGuiModel, SIGNAL(frontGraphChanged()), this, SLOT(updateBringToFrontGrapMenu()));
     connect(_pGuiModel, SIGNAL(frontGraphChanged()), _pGraphView, SLOT(bringToFront()));
     connect(_pGuiModel, SIGNAL(highlightSamplesChanged()), this, SLOT(updateHighlightSampleMenu()));
     connect(_pGuiModel, SIGNAL(highlightSamplesChanged()), _pGraphView, SLOT(enableSamplePoints()));
+    connect(_pGuiModel, SIGNAL(densityModeChanged()), this, SLOT(updateDensityModeMenu()));
+    connect(_pGuiModel, SIGNAL(densityModeChanged()), _pGraphView, SLOT(enableDensityMode()));
     connect(_pGuiModel, SIGNAL(cursorValuesChanged()), _pGraphView, SLOT(updateTooltip()));
     connect(_pGuiModel, SIGNAL(cursorValuesChanged()), _pLegend, SLOT(updateDataInLegend()));
 
@@ -92,12 +108,20 @@ MainWindow::MainWindow(QStringList cmdArguments, QWidget *parent) :
     connect(_pGraphDataModel, SIGNAL(colorChanged(quint32)), _pGraphView, SLOT(changeGraphColor(quint32)));
     connect(_pGraphDataModel, SIGNAL(labelChanged(quint32)), this, SLOT(handleGraphLabelChange(quint32)));
     connect(_pGraphDataModel, SIGNAL(labelChanged(quint32)), _pGraphView, SLOT(changeGraphLabel(quint32)));
+    connect(_pGraphDataModel, SIGNAL(scalingChanged(quint32)), _pGraphView, SLOT(changeGraphScaling(quint32)));
+    connect(_pGraphDataModel, SIGNAL(filterDataChanged()), _pGraphView, SLOT(updateFilterData()));
     connect(_pGraphDataModel, SIGNAL(added(quint32)), this, SLOT(rebuildGraphMenu()));
     connect(_pGraphDataModel, SIGNAL(added(quint32)), _pGraphView, SLOT(updateGraphs()));
 
     connect(_pGraphDataModel, SIGNAL(removed(quint32)), this, SLOT(rebuildGraphMenu()));
     connect(_pGraphDataModel, SIGNAL(removed(quint32)), _pGraphView, SLOT(updateGraphs()));
 
+    /* Batched changes: rebuild once */
+    connect(_pGraphDataModel, SIGNAL(graphListChanged()), this, SLOT(rebuildGraphMenu()));
+    connect(_pGraphDataModel, SIGNAL(graphListChanged()), _pGraphView, SLOT(updateGraphs()));
+    connect(_pGraphDataModel, SIGNAL(graphPropertiesChanged()), this, SLOT(rebuildGraphMenu()));
+    connect(_pGraphDataModel, SIGNAL(graphPropertiesChanged()), _pGraphView, SLOT(updateGraphProperties()));
+
     connect(_pGuiModel, SIGNAL(watchFileChanged()), this, SLOT(enableWatchFile()));
     connect(_pParserModel, SIGNAL(dynamicSessionChanged()), this, SLOT(enableDynamicSession()));
 
@@ -262,6 +286,68 @@ void MainWindow::showYAxisScaleDialog()
     }
 }
 
+void MainWindow::windowAutoScaleYAxis()
+{
+    _pGuiModel->setyAxisScale(BasicGraphView::SCALE_WINDOW_AUTO);
+}
+
+void MainWindow::slidingScaleXAxis()
+{
+    _pGuiModel->setxAxisScale(BasicGraphView::SCALE_SLIDING);
+}
+
+void MainWindow::addDerivedGraph()
+{
+    bool bOk = false;
+    const QString label = QInputDialog::getText(this, "Add derived graph", "Label:", QLineEdit::Normal, QString("Derived %1").arg(_pGraphDataModel->size() + 1), &bOk);
+    if (!bOk || label.isEmpty())
+    {
+        return;
+    }
+
+    QString expression;
+    QString error;
+    do
+    {
+        expression = QInputDialog::getText(this, "Add derived graph", "Expression (for example: [label A] - [label B], abs(deriv([label A]))):", QLineEdit::Normal, expression, &bOk);
+        if (!bOk || expression.isEmpty())
+        {
+            return;
+        }
+
+        error.clear();
+        if (!_pGraphDataModel->addDerived(label, expression, &error))
+        {
+            QMessageBox::warning(this, "Add derived graph", QString("Invalid expression: %1").arg(error));
+        }
+
+    } while (!error.isEmpty());
+}
+
+void MainWindow::showCorrelationDialog()
+{
+    /* Dialog is kept to follow graph and marker changes */
+    if (_pCorrelationDialog == NULL)
+    {
+        _pCorrelationDialog = new CorrelationDialog(_pGuiModel, _pGraphDataModel, this);
+    }
+
+    _pCorrelationDialog->show();
+    _pCorrelationDialog->raise();
+}
+
+void MainWindow::showEventSearchDialog()
+{
+    /* Dialog is kept, so the last search can be repeated */
+    if (_pEventSearchDialog == NULL)
+    {
+        _pEventSearchDialog = new EventSearchDialog(_pGraphDataModel, _pGraphView, this);
+    }
+
+    _pEventSearchDialog->show();
+    _pEventSearchDialog->raise();
+}
+
 void MainWindow::menuBringToFrontGraphClicked(bool bState)
 {
     QAction * pAction = qobject_cast<QAction *>(QObject::sender());
@@ -346,6 +432,12 @@ void MainWindow::updateHighlightSampleMenu()
     _pUi->actionHighlightSamplePoints->setChecked(_pGuiModel->highlightSamples());
 }
 
+void MainWindow::updateDensityModeMenu()
+{
+    /* set menu to checked */
+    _pUi->actionDensityMode->setChecked(_pGuiModel->densityMode());
+}
+
 void MainWindow::rebuildGraphMenu()
 {
     // Regenerate graph menu
@@ -430,9 +522,16 @@ void MainWindow::updateGuiState()
 
         _pUi->actionWatchFile->setEnabled(false);
         _pUi->actionDynamicSession->setEnabled(false);
+        _pUi->actionAddDerivedGraph->setEnabled(false);
+        _pUi->actionShowCorrelation->setEnabled(false);
+        _pUi->actionFindEvent->setEnabled(false);
+        _pUi->actionNextEvent->setEnabled(false);
+        _pUi->actionPreviousEvent->setEnabled(false);
 
         _pUi->actionAutoScaleXAxis->setEnabled(false);
+        _pUi->actionSlidingScaleXAxis->setEnabled(false);
         _pUi->actionAutoScaleYAxis->setEnabled(false);
+        _pUi->actionWindowAutoScaleYAxis->setEnabled(false);
         _pUi->actionSetManualScaleXAxis->setEnabled(false);
         _pUi->actionSetManualScaleYAxis->setEnabled(false);
         _pUi->menuScale->setEnabled(false);
@@ -445,9 +544,16 @@ void MainWindow::updateGuiState()
         _pUi->actionReloadDataFile->setEnabled(true);
 
         _pUi->actionWatchFile->setEnabled(true);
+        _pUi->actionAddDerivedGraph->setEnabled(true);
+        _pUi->actionShowCorrelation->setEnabled(true);
+        _pUi->actionFindEvent->setEnabled(true);
+        _pUi->actionNextEvent->setEnabled(true);
+        _pUi->actionPreviousEvent->setEnabled(true);
 
         _pUi->actionAutoScaleXAxis->setEnabled(true);
+        _pUi->actionSlidingScaleXAxis->setEnabled(true);
         _pUi->actionAutoScaleYAxis->setEnabled(true);
+        _pUi->actionWindowAutoScaleYAxis->setEnabled(true);
         _pUi->actionSetManualScaleXAxis->setEnabled(true);
         _pUi->actionSetManualScaleYAxis->setEnabled(true);
         _pUi->menuScale->setEnabled(true);
@@ -583,7 +689,7 @@ void MainWindow::updateData(void)
 {
     if (_pParser->processDataFile())
     {
-        _pGraphView->addData(_pParser->timeRow(), _pParser->dataRows());
+        _pGraphView->addData(_pParser->timeRow(), _pParser->dataRows(), _pParser->unchangedRowCount());
     }
     else
     {
@@ -609,12 +715,26 @@ void MainWindow::handleCommandLineArguments(QStringList cmdArguments)
     QCommandLineOption openGlOption("opengl", QCoreApplication::translate("main", "Use openGL to render plot"));
     argumentParser.addOption(openGlOption);
 
+    // Frame budget argument
+    QCommandLineOption frameBudgetOption("frame-budget", QCoreApplication::translate("main", "Maximum render time of a frame in milliseconds before a coarse frame is shown first (0 to disable)"), "ms");
+    argumentParser.addOption(frameBudgetOption);
+
     // Process arguments
     argumentParser.process(cmdArguments);
 
     bool bOpenGl = argumentParser.isSet(openGlOption);
     _pGraphView->setOpenGl(bOpenGl);
 
+    if (argumentParser.isSet(frameBudgetOption))
+    {
+        bool bOk;
+        const qint32 frameBudget = argumentParser.value(frameBudgetOption).toInt(&bOk);
+        if (bOk)
+        {
+            _pGraphView->setFrameBudget(frameBudget);
+        }
+    }
+
     if (!argumentParser.positionalArguments().isEmpty())
     {
         QString filename = argumentParser.positionalArguments().first();
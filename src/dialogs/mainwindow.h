@@ -22,6 +22,8 @@ class WatchFile;
 class Legend;
 class DataFileParser;
 class LoadFileDialog;
+class CorrelationDialog;
+class EventSearchDialog;
 
 class MainWindow : public QMainWindow
 {
@@ -47,6 +49,11 @@ private slots:
     void showAbout();
     void showXAxisScaleDialog();
     void showYAxisScaleDialog();
+    void windowAutoScaleYAxis();
+    void slidingScaleXAxis();
+    void addDerivedGraph();
+    void showCorrelationDialog();
+    void showEventSearchDialog();
     void menuBringToFrontGraphClicked(bool bState);
     void menuShowHideGraphClicked(bool bState);
 
@@ -57,6 +64,7 @@ private slots:
 
     void updateBringToFrontGrapMenu();
     void updateHighlightSampleMenu();
+    void updateDensityModeMenu();
     void rebuildGraphMenu();
     void updateWindowTitle();
     void enableWatchFile();
@@ -102,6 +110,8 @@ private:
     QActionGroup * _pLegendPositionGroup;
 
     LoadFileDialog * _pLoadDataFileDialog;
+    CorrelationDialog * _pCorrelationDialog;
+    EventSearchDialog * _pEventSearchDialog;
 
     static const quint32 _cGraphShowHideIndex = 2;
 };
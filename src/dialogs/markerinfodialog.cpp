@@ -1,22 +1,22 @@
-#include <QFileInfo>
-#include <QFileDialog>
 #include <QMessageBox>
 
+#include "expression.h"
 #include "markerinfodialog.h"
 #include "ui_markerinfodialog.h"
 
 
-MarkerInfoDialog::MarkerInfoDialog(GuiModel *pGuiModel, QWidget *parent) :
+MarkerInfoDialog::MarkerInfoDialog(GuiModel *pGuiModel, GraphDataModel *pGraphDataModel, QWidget *parent) :
     QDialog(parent),
     _pUi(new Ui::MarkerInfoDialog)
 {
     _pUi->setupUi(this);
 
     _pGuiModel = pGuiModel;
+    _pGraphDataModel = pGraphDataModel;
 
     _expressionMask = 0;
 
-    /* Enable/disable custom script controls */
+    /* Enable/disable custom expression controls */
     connect(_pUi->checkCustom, &QCheckBox::stateChanged, this, &MarkerInfoDialog::customScriptStatechanged);
 
     /* Update mask */
@@ -26,9 +26,13 @@ MarkerInfoDialog::MarkerInfoDialog(GuiModel *pGuiModel, QWidget *parent) :
     connect(_pUi->checkMinimum, &QCheckBox::stateChanged, this, &MarkerInfoDialog::checkBoxStatechanged);
     connect(_pUi->checkDifference, &QCheckBox::stateChanged, this, &MarkerInfoDialog::checkBoxStatechanged);
     connect(_pUi->checkCustom, &QCheckBox::stateChanged, this, &MarkerInfoDialog::checkBoxStatechanged);
-
-    /* Connect file chooser signal */
-    connect(_pUi->btnCustom, &QToolButton::clicked, this, &MarkerInfoDialog::selectScriptFile);
+    connect(_pUi->checkStdDev, &QCheckBox::stateChanged, this, &MarkerInfoDialog::checkBoxStatechanged);
+    connect(_pUi->checkRms, &QCheckBox::stateChanged, this, &MarkerInfoDialog::checkBoxStatechanged);
+    connect(_pUi->checkIntegral, &QCheckBox::stateChanged, this, &MarkerInfoDialog::checkBoxStatechanged);
+    connect(_pUi->checkSampleCount, &QCheckBox::stateChanged, this, &MarkerInfoDialog::checkBoxStatechanged);
+    connect(_pUi->checkMedian, &QCheckBox::stateChanged, this, &MarkerInfoDialog::checkBoxStatechanged);
+    connect(_pUi->checkPercentile95, &QCheckBox::stateChanged, this, &MarkerInfoDialog::checkBoxStatechanged);
+    connect(_pUi->checkPercentile99, &QCheckBox::stateChanged, this, &MarkerInfoDialog::checkBoxStatechanged);
 
     /* set according to data in model */
     _pUi->lineCustom->setText(_pGuiModel->markerExpressionCustomScript());
@@ -65,6 +69,41 @@ MarkerInfoDialog::MarkerInfoDialog(GuiModel *pGuiModel, QWidget *parent) :
         _pUi->checkSlope->setChecked(true);
     }
 
+    if (mask & GuiModel::cStdDevMask)
+    {
+        _pUi->checkStdDev->setChecked(true);
+    }
+
+    if (mask & GuiModel::cRmsMask)
+    {
+        _pUi->checkRms->setChecked(true);
+    }
+
+    if (mask & GuiModel::cIntegralMask)
+    {
+        _pUi->checkIntegral->setChecked(true);
+    }
+
+    if (mask & GuiModel::cSampleCountMask)
+    {
+        _pUi->checkSampleCount->setChecked(true);
+    }
+
+    if (mask & GuiModel::cMedianMask)
+    {
+        _pUi->checkMedian->setChecked(true);
+    }
+
+    if (mask & GuiModel::cPercentile95Mask)
+    {
+        _pUi->checkPercentile95->setChecked(true);
+    }
+
+    if (mask & GuiModel::cPercentile99Mask)
+    {
+        _pUi->checkPercentile99->setChecked(true);
+    }
+
 }
 
 MarkerInfoDialog::~MarkerInfoDialog()
@@ -76,12 +115,10 @@ void MarkerInfoDialog::customScriptStatechanged(int state)
 {
     if (state == Qt::Unchecked)
     {
-        _pUi->btnCustom->setEnabled(false);
         _pUi->lineCustom->setEnabled(false);
     }
     else if (state == Qt::Checked)
     {
-        _pUi->btnCustom->setEnabled(true);
         _pUi->lineCustom->setEnabled(true);
     }
     else
@@ -120,6 +157,34 @@ void MarkerInfoDialog::checkBoxStatechanged(int state)
     {
         mask = GuiModel::cCustomMask;
     }
+    else if (pObj == _pUi->checkStdDev)
+    {
+        mask = GuiModel::cStdDevMask;
+    }
+    else if (pObj == _pUi->checkRms)
+    {
+        mask = GuiModel::cRmsMask;
+    }
+    else if (pObj == _pUi->checkIntegral)
+    {
+        mask = GuiModel::cIntegralMask;
+    }
+    else if (pObj == _pUi->checkSampleCount)
+    {
+        mask = GuiModel::cSampleCountMask;
+    }
+    else if (pObj == _pUi->checkMedian)
+    {
+        mask = GuiModel::cMedianMask;
+    }
+    else if (pObj == _pUi->checkPercentile95)
+    {
+        mask = GuiModel::cPercentile95Mask;
+    }
+    else if (pObj == _pUi->checkPercentile99)
+    {
+        mask = GuiModel::cPercentile99Mask;
+    }
     else
     {
         mask = 0u;
@@ -140,21 +205,6 @@ void MarkerInfoDialog::checkBoxStatechanged(int state)
     }
 }
 
-void MarkerInfoDialog::selectScriptFile()
-{
-    QFileDialog dialog(this);
-    dialog.setFileMode(QFileDialog::ExistingFile);
-    dialog.setAcceptMode(QFileDialog::AcceptOpen);
-    dialog.setOption(QFileDialog::HideNameFilterDetails, false);
-    dialog.setWindowTitle(tr("Select py script file"));
-    dialog.setNameFilter(tr("py files (*.py *.pyc)"));
-
-    if (dialog.exec())
-    {
-        _pUi->lineCustom->setText(dialog.selectedFiles().first());
-    }
-}
-
 void MarkerInfoDialog::done(int r)
 {
     bool bValid = true;
@@ -163,10 +213,9 @@ void MarkerInfoDialog::done(int r)
     {
         if (_pUi->checkCustom->checkState() == Qt::Checked)
         {
+            Expression expression;
 
-            QFileInfo fileInfo = QFileInfo(_pUi->lineCustom->text());
-
-            if (fileInfo.exists())
+            if (expression.compile(_pUi->lineCustom->text(), _pGraphDataModel->labelList()))
             {
                 bValid = true;
             }
@@ -176,9 +225,9 @@ void MarkerInfoDialog::done(int r)
 
                 /* TODO: change with Util::ShowError */
                 QMessageBox msgBox;
-                msgBox.setWindowTitle(tr("SCript file does not exist!"));
+                msgBox.setWindowTitle(tr("Invalid expression!"));
                 msgBox.setIcon(QMessageBox::Warning);
-                msgBox.setText(tr("Script file does not exist.\n\n%1").arg(_pUi->lineCustom->text()));
+                msgBox.setText(tr("Custom expression isn't valid.\n\n%1").arg(expression.errorString()));
                 msgBox.exec();
             }
         }
@@ -3,6 +3,7 @@
 
 #include <QDialog>
 #include "guimodel.h"
+#include "graphdatamodel.h"
 
 namespace Ui {
 class MarkerInfoDialog;
@@ -13,13 +14,12 @@ class MarkerInfoDialog : public QDialog
     Q_OBJECT
 
 public:
-    explicit MarkerInfoDialog(GuiModel *pGuiModel, QWidget *parent = 0);
+    explicit MarkerInfoDialog(GuiModel *pGuiModel, GraphDataModel *pGraphDataModel, QWidget *parent = 0);
     ~MarkerInfoDialog();
 
 private slots:
     void customScriptStatechanged(int state);
     void checkBoxStatechanged(int state);
-    void selectScriptFile();
 
     void done(int r);
 
@@ -29,6 +29,7 @@ private:
     quint32 _expressionMask;
 
     GuiModel * _pGuiModel;
+    GraphDataModel * _pGraphDataModel;
 };
 
 #endif // MARKERINFODIALOG_H
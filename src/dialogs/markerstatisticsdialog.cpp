@@ -0,0 +1,287 @@
+#include <QFileDialog>
+#include <QTextStream>
+#include <QtConcurrent>
+
+#include "guimodel.h"
+#include "graphdatamodel.h"
+#include "markerexpression.h"
+#include "util.h"
+
+#include "markerstatisticsdialog.h"
+#include "ui_markerstatisticsdialog.h"
+
+MarkerStatisticsDialog::MarkerStatisticsDialog(GuiModel *pGuiModel, GraphDataModel * pGraphDataModel, QWidget *parent) :
+    QDialog(parent),
+    _pUi(new Ui::MarkerStatisticsDialog)
+{
+    _pUi->setupUi(this);
+
+    /* Disable question mark button */
+    setWindowFlags(windowFlags() & ~Qt::WindowContextHelpButtonHint);
+
+    _pGuiModel = pGuiModel;
+    _pGraphDataModel = pGraphDataModel;
+
+    _bOutdated = false;
+
+    connect(_pUi->btnExport, &QPushButton::clicked, this, &MarkerStatisticsDialog::exportToCsv);
+
+    /* Graph list or columns change: rebuild complete table */
+    connect(_pGraphDataModel, SIGNAL(activeChanged(quint32)), this, SLOT(rebuildTable()));
+    connect(_pGraphDataModel, SIGNAL(added(quint32)), this, SLOT(rebuildTable()));
+    connect(_pGraphDataModel, SIGNAL(removed(quint32)), this, SLOT(rebuildTable()));
+    connect(_pGraphDataModel, SIGNAL(graphListChanged()), this, SLOT(rebuildTable()));
+    connect(_pGuiModel, SIGNAL(markerExpressionMaskChanged()), this, SLOT(rebuildTable()));
+
+    /* Only update changed cells */
+    connect(_pGraphDataModel, SIGNAL(graphPropertiesChanged()), this, SLOT(updateProperties()));
+    connect(_pGraphDataModel, SIGNAL(labelChanged(quint32)), this, SLOT(updateLabel(quint32)));
+    connect(_pGraphDataModel, SIGNAL(colorChanged(quint32)), this, SLOT(updateColor(quint32)));
+    connect(_pGraphDataModel, SIGNAL(scalingChanged(quint32)), this, SLOT(updateValues()));
+    connect(_pGuiModel, SIGNAL(startMarkerPosChanged()), this, SLOT(updateValues()));
+    connect(_pGuiModel, SIGNAL(endMarkerPosChanged()), this, SLOT(updateValues()));
+    connect(_pGuiModel, SIGNAL(markerStateChanged()), this, SLOT(updateValues()));
+
+    rebuildTable();
+}
+
+MarkerStatisticsDialog::~MarkerStatisticsDialog()
+{
+    delete _pUi;
+}
+
+void MarkerStatisticsDialog::showEvent(QShowEvent * event)
+{
+    QDialog::showEvent(event);
+
+    if (_bOutdated)
+    {
+        rebuildTable();
+    }
+}
+
+void MarkerStatisticsDialog::rebuildTable()
+{
+    /* Dialog is kept when closed, only calculate when it is shown */
+    if (!isVisible())
+    {
+        _bOutdated = true;
+        return;
+    }
+
+    _bOutdated = false;
+
+    _pGraphDataModel->activeGraphIndexList(&_graphList);
+
+    _expressionBits.clear();
+
+    QStringList headers;
+    headers.append(tr("Graph"));
+    headers.append(GuiModel::cMarkerExpressionStart.section(':', 0, 0));
+    headers.append(GuiModel::cMarkerExpressionEnd.section(':', 0, 0));
+
+    const quint32 mask = _pGuiModel->markerExpressionMask();
+    for(qint32 idx = 0; idx < GuiModel::cMarkerExpressionBits.size(); idx++)
+    {
+        /* Custom expression isn't supported in table */
+        if (
+            (mask & GuiModel::cMarkerExpressionBits[idx])
+            && (GuiModel::cMarkerExpressionBits[idx] != GuiModel::cCustomMask)
+            )
+        {
+            _expressionBits.append(GuiModel::cMarkerExpressionBits[idx]);
+            headers.append(GuiModel::cMarkerExpressionStrings[idx].section(':', 0, 0));
+        }
+    }
+
+    _pUi->tableStatistics->clear();
+    _pUi->tableStatistics->setColumnCount(headers.size());
+    _pUi->tableStatistics->setRowCount(_graphList.size());
+    _pUi->tableStatistics->setHorizontalHeaderLabels(headers);
+
+    for (qint32 row = 0; row < _graphList.size(); row++)
+    {
+        _pUi->tableStatistics->setItem(row, 0, new QTableWidgetItem(_pGraphDataModel->label(_graphList[row])));
+        updateColor(_graphList[row]);
+
+        for (qint32 column = 1; column < headers.size(); column++)
+        {
+            QTableWidgetItem * pItem = new QTableWidgetItem();
+            pItem->setTextAlignment(Qt::AlignRight | Qt::AlignVCenter);
+            _pUi->tableStatistics->setItem(row, column, pItem);
+        }
+    }
+
+    updateValues();
+}
+
+void MarkerStatisticsDialog::updateValues()
+{
+    if (!isVisible())
+    {
+        _bOutdated = true;
+        return;
+    }
+
+    const double startPos = _pGuiModel->startMarkerPos();
+    const double endPos = _pGuiModel->endMarkerPos();
+    const QList<quint32> expressionBits = _expressionBits;
+
+    QCPRange markerRange(startPos, endPos);
+    markerRange.normalize();
+
+    QVector<GraphStatistics> statisticsList(_graphList.size());
+
+    for (qint32 row = 0; row < _graphList.size(); row++)
+    {
+        statisticsList[row].pDataMap = _pGraphDataModel->dataMap(_graphList[row], markerRange);
+        statisticsList[row].pDataIndex = _pGraphDataModel->dataIndex(_graphList[row]);
+        statisticsList[row].gain = _pGraphDataModel->gain(_graphList[row]);
+        statisticsList[row].offset = _pGraphDataModel->offset(_graphList[row]);
+
+        /* Index is only read during calculation */
+        statisticsList[row].pDataIndex->synchronize();
+    }
+
+    /* Spread graphs over thread pool, GUI thread waits because data can't change during calculation */
+    QtConcurrent::blockingMap(statisticsList, [startPos, endPos, expressionBits](GraphStatistics &statistics)
+    {
+        statistics.values.append(statistics.gain * valueAtMarker(statistics.pDataMap, startPos) + statistics.offset);
+        statistics.values.append(statistics.gain * valueAtMarker(statistics.pDataMap, endPos) + statistics.offset);
+
+        foreach(quint32 expressionMask, expressionBits)
+        {
+            statistics.values.append(MarkerExpression::calculate(statistics.pDataMap, statistics.pDataIndex, startPos, endPos, expressionMask,
+                                                                 statistics.gain, statistics.offset));
+        }
+    });
+
+    for (qint32 row = 0; row < statisticsList.size(); row++)
+    {
+        const QVector<double> &values = statisticsList[row].values;
+
+        for (qint32 valueIdx = 0; valueIdx < values.size(); valueIdx++)
+        {
+            QTableWidgetItem * pItem = _pUi->tableStatistics->item(row, valueIdx + 1);
+
+            if (pItem != NULL)
+            {
+                if (_pGuiModel->markerState())
+                {
+                    pItem->setText(Util::formatDoubleForExport(values[valueIdx]));
+                }
+                else
+                {
+                    pItem->setText("");
+                }
+            }
+        }
+    }
+}
+
+/*!
+ * Batch of property changes (visibility, label or color): rows stay the same
+ */
+void MarkerStatisticsDialog::updateProperties()
+{
+    /* Graph list could be outdated, complete table is rebuilt when shown */
+    if (_bOutdated)
+    {
+        return;
+    }
+
+    foreach(quint16 graphIdx, _graphList)
+    {
+        updateLabel(graphIdx);
+        updateColor(graphIdx);
+    }
+}
+
+void MarkerStatisticsDialog::updateLabel(quint32 graphIdx)
+{
+    const qint32 row = _graphList.indexOf(static_cast<quint16>(graphIdx));
+
+    if (row != -1)
+    {
+        _pUi->tableStatistics->item(row, 0)->setText(_pGraphDataModel->label(graphIdx));
+    }
+}
+
+void MarkerStatisticsDialog::updateColor(quint32 graphIdx)
+{
+    const qint32 row = _graphList.indexOf(static_cast<quint16>(graphIdx));
+
+    if (row != -1)
+    {
+        QPixmap pixmap(20,5);
+        pixmap.fill(_pGraphDataModel->color(graphIdx));
+
+        _pUi->tableStatistics->item(row, 0)->setIcon(QIcon(pixmap));
+    }
+}
+
+void MarkerStatisticsDialog::exportToCsv()
+{
+    QString filePath;
+    QFileDialog dialog(this);
+    dialog.setFileMode(QFileDialog::AnyFile);
+    dialog.setAcceptMode(QFileDialog::AcceptSave);
+    dialog.setOption(QFileDialog::HideNameFilterDetails, false);
+    dialog.setDefaultSuffix("csv");
+    dialog.setWindowTitle(tr("Select csv file"));
+    dialog.setNameFilter(tr("CSV files (*.csv)"));
+    dialog.setDirectory(_pGuiModel->lastDir());
+
+    if (dialog.exec())
+    {
+        filePath = dialog.selectedFiles().first();
+        _pGuiModel->setLastDir(QFileInfo(filePath).dir().absolutePath());
+
+        QFile file(filePath);
+
+        if (file.open(QIODevice::WriteOnly | QIODevice::Text))
+        {
+            QTextStream stream(&file);
+            const QChar separator = Util::separatorCharacter();
+
+            QStringList fields;
+            for (qint32 column = 0; column < _pUi->tableStatistics->columnCount(); column++)
+            {
+                fields.append(Util::csvField(_pUi->tableStatistics->horizontalHeaderItem(column)->text(), separator));
+            }
+            stream << fields.join(separator) << "\n";
+
+            for (qint32 row = 0; row < _pUi->tableStatistics->rowCount(); row++)
+            {
+                fields.clear();
+                for (qint32 column = 0; column < _pUi->tableStatistics->columnCount(); column++)
+                {
+                    fields.append(Util::csvField(_pUi->tableStatistics->item(row, column)->text(), separator));
+                }
+                stream << fields.join(separator) << "\n";
+            }
+        }
+        else
+        {
+            Util::showError(tr("Couldn't write to file: %1").arg(filePath));
+        }
+    }
+}
+
+double MarkerStatisticsDialog::valueAtMarker(QSharedPointer<QCPGraphDataContainer> pDataMap, double markerPos)
+{
+    /* Graph without samples is shown as placeholder */
+    if (pDataMap->isEmpty())
+    {
+        return GraphDataModel::cPlaceholderValue;
+    }
+
+    QCPGraphDataContainer::const_iterator it = pDataMap->findBegin(markerPos, false);
+
+    if (it == pDataMap->constEnd())
+    {
+        it--;
+    }
+
+    return it->value;
+}
@@ -0,0 +1,60 @@
+#ifndef MARKERSTATISTICSDIALOG_H
+#define MARKERSTATISTICSDIALOG_H
+
+#include <QDialog>
+#include "qcustomplot.h"
+
+/* Forward declarations */
+class GuiModel;
+class GraphDataModel;
+class GraphDataIndex;
+
+namespace Ui {
+class MarkerStatisticsDialog;
+}
+
+class MarkerStatisticsDialog : public QDialog
+{
+    Q_OBJECT
+
+public:
+    explicit MarkerStatisticsDialog(GuiModel *pGuiModel, GraphDataModel * pGraphDataModel, QWidget *parent = 0);
+    ~MarkerStatisticsDialog();
+
+protected:
+    void showEvent(QShowEvent * event);
+
+private slots:
+    void rebuildTable();
+    void updateValues();
+    void updateProperties();
+    void updateLabel(quint32 graphIdx);
+    void updateColor(quint32 graphIdx);
+    void exportToCsv();
+
+private:
+
+    typedef struct
+    {
+        QSharedPointer<QCPGraphDataContainer> pDataMap;
+        QSharedPointer<GraphDataIndex> pDataIndex;
+        double gain;
+        double offset;
+        QVector<double> values;
+
+    } GraphStatistics;
+
+    static double valueAtMarker(QSharedPointer<QCPGraphDataContainer> pDataMap, double markerPos);
+
+    Ui::MarkerStatisticsDialog * _pUi;
+
+    GuiModel * _pGuiModel;
+    GraphDataModel * _pGraphDataModel;
+
+    QList<quint16> _graphList; // Graph index of every row
+    QList<quint32> _expressionBits; // Expression of every value column
+
+    bool _bOutdated; // Changes while hidden, table is rebuilt when shown
+};
+
+#endif // MARKERSTATISTICSDIALOG_H
@@ -0,0 +1,264 @@
+#include <QtConcurrent>
+
+#include "guimodel.h"
+#include "graphdatamodel.h"
+#include "util.h"
+
+#include "spectrumdialog.h"
+#include "ui_spectrumdialog.h"
+
+SpectrumDialog::SpectrumDialog(GuiModel *pGuiModel, GraphDataModel * pGraphDataModel, QWidget *parent) :
+    QDialog(parent),
+    _pUi(new Ui::SpectrumDialog)
+{
+    _pUi->setupUi(this);
+
+    /* Disable question mark button */
+    setWindowFlags(windowFlags() & ~Qt::WindowContextHelpButtonHint);
+
+    _pGuiModel = pGuiModel;
+    _pGraphDataModel = pGraphDataModel;
+
+    _generation.store(0);
+    _runningGeneration = 0;
+    _bPending = false;
+    _bOutdated = false;
+
+    /* Segment length sets the frequency resolution, more segments give a smoother spectrum */
+    for (qint32 length = 256; length <= 65536; length *= 4)
+    {
+        _pUi->comboSegmentLength->addItem(QString::number(length), length);
+    }
+    _pUi->comboSegmentLength->setCurrentIndex(_pUi->comboSegmentLength->findData(_cDefaultSegmentLength));
+
+    QCustomPlot * pPlot = _pUi->plotSpectrum;
+    pPlot->addGraph();
+    pPlot->xAxis->setLabel("Frequency (Hz)");
+    pPlot->yAxis->setLabel("Amplitude (RMS)");
+    pPlot->yAxis->setScaleType(QCPAxis::stLogarithmic);
+    pPlot->yAxis->setTicker(QSharedPointer<QCPAxisTickerLog>(new QCPAxisTickerLog));
+    pPlot->setInteractions(QCP::iRangeDrag | QCP::iRangeZoom);
+
+    connect(&_spectrumWatcher, &QFutureWatcher<Spectrum::Result>::finished, this, &SpectrumDialog::spectrumFinished);
+
+    /* Graph list changes */
+    connect(_pGraphDataModel, SIGNAL(activeChanged(quint32)), this, SLOT(updateGraphList()));
+    connect(_pGraphDataModel, SIGNAL(added(quint32)), this, SLOT(updateGraphList()));
+    connect(_pGraphDataModel, SIGNAL(removed(quint32)), this, SLOT(updateGraphList()));
+    connect(_pGraphDataModel, SIGNAL(labelChanged(quint32)), this, SLOT(updateGraphList()));
+    connect(_pGraphDataModel, SIGNAL(graphListChanged()), this, SLOT(updateGraphList()));
+    connect(_pGraphDataModel, SIGNAL(graphPropertiesChanged()), this, SLOT(updateGraphList()));
+
+    /* Calculate again when input changes */
+    connect(_pGraphDataModel, SIGNAL(scalingChanged(quint32)), this, SLOT(requestSpectrum()));
+    connect(_pGuiModel, SIGNAL(startMarkerPosChanged()), this, SLOT(requestSpectrum()));
+    connect(_pGuiModel, SIGNAL(endMarkerPosChanged()), this, SLOT(requestSpectrum()));
+    connect(_pGuiModel, SIGNAL(markerStateChanged()), this, SLOT(requestSpectrum()));
+    connect(_pUi->comboGraph, SIGNAL(currentIndexChanged(int)), this, SLOT(requestSpectrum()));
+    connect(_pUi->comboSegmentLength, SIGNAL(currentIndexChanged(int)), this, SLOT(requestSpectrum()));
+
+    updateGraphList();
+}
+
+SpectrumDialog::~SpectrumDialog()
+{
+    /* Stop running calculation */
+    _generation.fetchAndAddOrdered(1);
+    _spectrumWatcher.waitForFinished();
+
+    delete _pUi;
+}
+
+void SpectrumDialog::showEvent(QShowEvent * event)
+{
+    QDialog::showEvent(event);
+
+    if (_bOutdated)
+    {
+        requestSpectrum();
+    }
+}
+
+void SpectrumDialog::hideEvent(QHideEvent * event)
+{
+    QDialog::hideEvent(event);
+
+    /* Stop running calculation, result isn't shown anyway */
+    _generation.fetchAndAddOrdered(1);
+    _bPending = false;
+    _bOutdated = true;
+}
+
+void SpectrumDialog::updateGraphList()
+{
+    const qint32 selectedIdx = _pUi->comboGraph->currentData().toInt();
+
+    QList<quint16> activeGraphList;
+    _pGraphDataModel->activeGraphIndexList(&activeGraphList);
+
+    _pUi->comboGraph->blockSignals(true);
+    _pUi->comboGraph->clear();
+
+    foreach(quint16 graphIdx, activeGraphList)
+    {
+        QPixmap pixmap(20,5);
+        pixmap.fill(_pGraphDataModel->color(graphIdx));
+
+        _pUi->comboGraph->addItem(QIcon(pixmap), _pGraphDataModel->label(graphIdx), QVariant(graphIdx));
+    }
+
+    const qint32 comboIdx = _pUi->comboGraph->findData(selectedIdx);
+    _pUi->comboGraph->setCurrentIndex(comboIdx != -1 ? comboIdx : 0);
+    _pUi->comboGraph->blockSignals(false);
+
+    requestSpectrum();
+}
+
+void SpectrumDialog::requestSpectrum()
+{
+    /* Outdates running calculation */
+    const qint32 generation = _generation.fetchAndAddOrdered(1) + 1;
+
+    if (!isVisible())
+    {
+        _bPending = false;
+        _bOutdated = true;
+        return;
+    }
+
+    _bOutdated = false;
+
+    const qint32 graphIdx = _pUi->comboGraph->currentData().toInt();
+
+    if (
+        !_pGuiModel->markerState()
+        || (_pUi->comboGraph->count() == 0)
+        )
+    {
+        _bPending = false;
+
+        _pUi->plotSpectrum->graph(0)->data()->clear();
+        _pUi->plotSpectrum->replot();
+        _pUi->labelStatus->setText(tr("Set start and end marker to show the spectrum of a graph"));
+
+        return;
+    }
+
+    QCPRange markerRange(_pGuiModel->startMarkerPos(), _pGuiModel->endMarkerPos());
+    markerRange.normalize();
+
+    Request request;
+    request.pDataMap = _pGraphDataModel->dataMap(graphIdx, markerRange);
+    request.gain = _pGraphDataModel->gain(graphIdx);
+    request.offset = _pGraphDataModel->offset(graphIdx);
+    request.startPos = _pGuiModel->startMarkerPos();
+    request.endPos = _pGuiModel->endMarkerPos();
+    request.maxSegmentLength = _pUi->comboSegmentLength->currentData().toInt();
+    request.generation = generation;
+
+    if (_spectrumWatcher.isRunning())
+    {
+        /* Only keep most recent request */
+        _pendingRequest = request;
+        _bPending = true;
+    }
+    else
+    {
+        startRequest(request);
+    }
+}
+
+void SpectrumDialog::spectrumFinished()
+{
+    const Spectrum::Result result = _spectrumWatcher.result();
+    const bool bCurrent = _runningGeneration == _generation.load();
+
+    if (_bPending)
+    {
+        _bPending = false;
+        startRequest(_pendingRequest);
+    }
+
+    if (!bCurrent)
+    {
+        /* Calculation is outdated */
+    }
+    else if (result.bValid)
+    {
+        /* DC isn't shown: the mean is removed and it can't be shown on a logarithmic axis */
+        _pUi->plotSpectrum->graph(0)->setData(result.frequencies.mid(1), result.amplitudes.mid(1), true);
+        _pUi->plotSpectrum->rescaleAxes();
+        _pUi->plotSpectrum->replot();
+
+        _pUi->labelStatus->setText(tr("Sample rate: %1 Hz, resolution: %2 Hz, %3 segments of %4 samples")
+                                   .arg(Util::formatDoubleForExport(result.sampleRate))
+                                   .arg(Util::formatDoubleForExport(result.sampleRate / result.segmentLength))
+                                   .arg(result.segmentCount)
+                                   .arg(result.segmentLength));
+    }
+    else
+    {
+        _pUi->plotSpectrum->graph(0)->data()->clear();
+        _pUi->plotSpectrum->replot();
+        _pUi->labelStatus->setText(tr("Not enough samples between markers"));
+    }
+}
+
+void SpectrumDialog::startRequest(const Request &request)
+{
+    _pUi->labelStatus->setText(tr("Calculating..."));
+
+    _runningGeneration = request.generation;
+
+    _spectrumWatcher.setFuture(QtConcurrent::run(SpectrumDialog::calculate, request, _pGraphDataModel->dataLock(), &_generation));
+}
+
+/*!
+ * Runs on worker thread: copy samples between markers and calculate spectrum
+ * The keys are in milliseconds, the sample rate is derived from the average sample interval
+ */
+Spectrum::Result SpectrumDialog::calculate(Request request, QReadWriteLock * pDataLock, const QAtomicInt * pGeneration)
+{
+    QReadLocker locker(pDataLock);
+
+    const QCPGraphDataContainer * pDataMap = request.pDataMap.data();
+
+    const double lowerPos = qMin(request.startPos, request.endPos);
+    const double upperPos = qMax(request.startPos, request.endPos);
+
+    const QCPGraphDataContainer::const_iterator beginIt = pDataMap->findBegin(lowerPos, false);
+    const QCPGraphDataContainer::const_iterator endIt = pDataMap->findEnd(upperPos, false);
+
+    QVector<double> samples;
+    double sampleRate = 0;
+
+    if (endIt - beginIt >= 2)
+    {
+        samples.resize(endIt - beginIt);
+
+        /* NaN samples hold the previous value */
+        double previousValue = 0;
+        qint32 idx = 0;
+        for (QCPGraphDataContainer::const_iterator it = beginIt; it != endIt; it++, idx++)
+        {
+            if (!qIsNaN(it->value))
+            {
+                previousValue = request.gain * it->value + request.offset;
+            }
+
+            samples[idx] = previousValue;
+        }
+
+        const double duration = (endIt - 1)->key - beginIt->key;
+        if (duration > 0)
+        {
+            sampleRate = (samples.size() - 1) * 1000 / duration;
+        }
+    }
+
+    locker.unlock();
+
+    const qint32 segmentLength = Spectrum::segmentLength(samples.size(), request.maxSegmentLength);
+
+    return Spectrum::calculate(samples, sampleRate, segmentLength, pGeneration, request.generation);
+}
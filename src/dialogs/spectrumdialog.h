@@ -0,0 +1,76 @@
+#ifndef SPECTRUMDIALOG_H
+#define SPECTRUMDIALOG_H
+
+#include <QDialog>
+#include <QFutureWatcher>
+#include <QAtomicInt>
+#include "qcustomplot.h"
+#include "spectrum.h"
+
+/* Forward declarations */
+class GuiModel;
+class GraphDataModel;
+
+namespace Ui {
+class SpectrumDialog;
+}
+
+/*
+ * Spectrum of the selected graph between the start and end marker
+ *
+ * The spectrum is calculated on a worker thread. Every request increments the generation,
+ * so a running calculation stops as soon as it is outdated. While a calculation is running,
+ * only the most recent request is kept and started when the calculation has finished.
+ * Nothing is calculated while the dialog is hidden, the spectrum is requested again when it is shown.
+ * */
+class SpectrumDialog : public QDialog
+{
+    Q_OBJECT
+
+public:
+    explicit SpectrumDialog(GuiModel *pGuiModel, GraphDataModel * pGraphDataModel, QWidget *parent = 0);
+    ~SpectrumDialog();
+
+protected:
+    void showEvent(QShowEvent * event);
+    void hideEvent(QHideEvent * event);
+
+private slots:
+    void updateGraphList();
+    void requestSpectrum();
+    void spectrumFinished();
+
+private:
+
+    typedef struct
+    {
+        QSharedPointer<QCPGraphDataContainer> pDataMap;
+        double gain;
+        double offset;
+        double startPos;
+        double endPos;
+        qint32 maxSegmentLength;
+        qint32 generation;
+
+    } Request;
+
+    void startRequest(const Request &request);
+    static Spectrum::Result calculate(Request request, QReadWriteLock * pDataLock, const QAtomicInt * pGeneration);
+
+    Ui::SpectrumDialog * _pUi;
+
+    GuiModel * _pGuiModel;
+    GraphDataModel * _pGraphDataModel;
+
+    QFutureWatcher<Spectrum::Result> _spectrumWatcher;
+    QAtomicInt _generation;
+    qint32 _runningGeneration;
+
+    Request _pendingRequest;
+    bool _bPending;
+    bool _bOutdated; // Changes while hidden, spectrum is requested when shown
+
+    static const qint32 _cDefaultSegmentLength = 4096;
+};
+
+#endif // SPECTRUMDIALOG_H
@@ -0,0 +1,415 @@
+#include <QtConcurrent>
+#include <QtMath>
+
+#include <algorithm> // std::stable_sort
+
+#include "myqcpgraph.h"
+#include "asyncgraphrenderer.h"
+
+AsyncGraphRenderer::AsyncGraphRenderer(QCustomPlot * pPlot, QCPAxis * pKeyAxis, QCPAxis * pValueAxis, QReadWriteLock * pDataLock) :
+    QCPLayerable(pPlot)
+{
+    _pKeyAxis = pKeyAxis;
+    _pValueAxis = pValueAxis;
+    _pDataLock = pDataLock;
+
+    _bDensity = false;
+    _bPending = false;
+    _bFinished = false;
+    _bPrefetching = false;
+    _lastKeyCenter = 0;
+    _panDirection = 0;
+
+    _frameBudget = _cDefaultFrameBudget;
+    _runningPointCount = 0;
+    _nsPerPoint = 0;
+
+    _refineTimer.setSingleShot(true);
+    _refineTimer.setInterval(_cRefineDelay);
+
+    connect(&_renderWatcher, &QFutureWatcher<GraphRasterizer::Frame>::finished, this, &AsyncGraphRenderer::frameFinished);
+    connect(&_refineTimer, &QTimer::timeout, this, &AsyncGraphRenderer::refineFrame);
+}
+
+AsyncGraphRenderer::~AsyncGraphRenderer()
+{
+    _renderWatcher.waitForFinished();
+}
+
+/*!
+ * Set maximum render time of a frame (in milliseconds) before a coarse frame is shown first
+ * A budget of 0 always renders full frames
+ */
+void AsyncGraphRenderer::setFrameBudget(qint32 budget)
+{
+    _frameBudget = qMax(budget, 0);
+}
+
+/*!
+ * Draw density of all graphs instead of separate lines
+ */
+void AsyncGraphRenderer::setDensityMode(bool bDensity)
+{
+    _bDensity = bDensity;
+}
+
+QRect AsyncGraphRenderer::clipRect() const
+{
+    return _pKeyAxis->axisRect()->rect();
+}
+
+void AsyncGraphRenderer::applyDefaultAntialiasingHint(QCPPainter *painter) const
+{
+    applyAntialiasingHint(painter, mAntialiased, QCP::aePlottables);
+}
+
+void AsyncGraphRenderer::draw(QCPPainter *painter)
+{
+    const GraphRasterizer::Frame frame = currentFrame(painter->antialiasing());
+
+    if (painter->modes().testFlag(QCPPainter::pmNoCaching))
+    {
+        /* Export: wait for complete image, tiles of export size aren't cached */
+        GraphRasterizer::Frame exportFrame = frame;
+        if (
+            (frame.keyRange.size() > 0)
+            && (frame.size.width() > 0)
+            )
+        {
+            exportFrame.tileScale = frame.size.width() / frame.keyRange.size();
+
+            qint64 firstTile;
+            qint64 lastTile;
+            GraphRasterizer::tileRange(exportFrame, &firstTile, &lastTile);
+
+            for (qint64 tileIdx = firstTile; tileIdx <= lastTile; tileIdx++)
+            {
+                GraphRasterizer::Tile tile;
+                tile.index = tileIdx;
+                exportFrame.tiles.append(tile);
+            }
+        }
+
+        drawFrame(painter, GraphRasterizer::render(exportFrame));
+    }
+    else
+    {
+        if (!(_bFinished && GraphRasterizer::isEqual(frame, _finishedFrame)))
+        {
+            requestFrame(frame);
+        }
+
+        if (_bFinished)
+        {
+            drawFrame(painter, _finishedFrame);
+        }
+    }
+}
+
+void AsyncGraphRenderer::frameFinished()
+{
+    const bool bPrefetch = _bPrefetching;
+    _bPrefetching = false;
+
+    const GraphRasterizer::Frame frame = _renderWatcher.result();
+    _tileCache.insert(frame);
+
+    /* Update estimate of render time per point with full frames */
+    if (
+        (frame.decimation == 1)
+        && (_runningPointCount >= _cMinMeasurePointCount)
+        )
+    {
+        const double nsPerPoint = static_cast<double>(_renderTimer.nsecsElapsed()) / _runningPointCount;
+        _nsPerPoint = (_nsPerPoint > 0) ? (_nsPerPoint + nsPerPoint) / 2 : nsPerPoint;
+    }
+
+    if (!bPrefetch)
+    {
+        /* Tiles are in cache, only keep the composited image */
+        _finishedFrame = frame;
+        _finishedFrame.tiles.clear();
+        _bFinished = true;
+
+        mParentPlot->replot(QCustomPlot::rpQueuedReplot);
+    }
+
+    _runningFrame.tiles.clear();
+
+    _tileCache.trim(GraphRasterizer::tileIndex(_finishedFrame.keyRange.center(), _finishedFrame.tileScale));
+
+    if (
+        _bPending
+        && !GraphRasterizer::isEqual(_pendingFrame, _finishedFrame)
+        )
+    {
+        _bPending = false;
+        startFrame(_pendingFrame, true);
+    }
+    else
+    {
+        _bPending = false;
+
+        if (frame.decimation > 1)
+        {
+            /* Refine coarse frame when view doesn't change anymore */
+            _refineTimer.start();
+        }
+        else if (!bPrefetch)
+        {
+            /* Idle: render neighbouring tiles */
+            startPrefetch();
+        }
+        else
+        {
+            // Nothing to do
+        }
+    }
+}
+
+GraphRasterizer::Frame AsyncGraphRenderer::currentFrame(bool bAntialiased) const
+{
+    GraphRasterizer::Frame frame;
+
+    frame.size = _pKeyAxis->axisRect()->rect().size();
+    frame.pixelRatio = mParentPlot->bufferDevicePixelRatio();
+    frame.keyRange = _pKeyAxis->range();
+    frame.valueRange = _pValueAxis->range();
+    frame.bAntialiased = bAntialiased;
+    frame.bDensity = _bDensity;
+    frame.pDataLock = _pDataLock;
+    frame.tileScale = 0;
+    frame.decimation = 1;
+
+    /* Keep order of layers (bring to front), then order of graphs */
+    QList<QPair<qint32, MyQCPGraph *> > graphList;
+    for (qint32 graphIdx = 0; graphIdx < mParentPlot->graphCount(); graphIdx++)
+    {
+        MyQCPGraph * pGraph = dynamic_cast<MyQCPGraph *>(mParentPlot->graph(graphIdx));
+
+        if (
+            (pGraph != NULL)
+            && pGraph->externalRendering()
+            && pGraph->realVisibility()
+            && (pGraph->keyAxis() == _pKeyAxis)
+            )
+        {
+            graphList.append(qMakePair(pGraph->layer()->index(), pGraph));
+        }
+    }
+
+    std::stable_sort(graphList.begin(), graphList.end(),
+                     [](const QPair<qint32, MyQCPGraph *> &left, const QPair<qint32, MyQCPGraph *> &right)
+                     {
+                         return left.first < right.first;
+                     });
+
+    for (qint32 idx = 0; idx < graphList.size(); idx++)
+    {
+        MyQCPGraph * pGraph = graphList[idx].second;
+
+        GraphRasterizer::GraphLayer graph;
+        graph.pDataMap = pGraph->renderData();
+        graph.dataSize = graph.pDataMap->size();
+        graph.dataRevision = pGraph->dataRevision();
+        graph.pDataIndex = pGraph->dataIndex();
+        graph.pen = pGraph->pen();
+        graph.gain = pGraph->gain();
+        graph.offset = pGraph->offset();
+        graph.scatterSize = pGraph->scatterStyle().isNone() ? 0 : pGraph->scatterStyle().size();
+        if (graph.scatterSize > 0)
+        {
+            graph.scatterSprite = scatterSprite(graph.pen, graph.scatterSize, frame.pixelRatio, bAntialiased);
+        }
+
+        frame.graphs.append(graph);
+    }
+
+    return frame;
+}
+
+void AsyncGraphRenderer::requestFrame(const GraphRasterizer::Frame &frame)
+{
+    if (_renderWatcher.isRunning())
+    {
+        if (!GraphRasterizer::isEqual(frame, _runningFrame))
+        {
+            /* Replace older request */
+            _pendingFrame = frame;
+            _bPending = true;
+        }
+        else
+        {
+            _bPending = false;
+        }
+    }
+    else
+    {
+        startFrame(frame, true);
+    }
+}
+
+/*!
+ * Replace finished coarse frame with a full frame
+ */
+void AsyncGraphRenderer::refineFrame()
+{
+    /* When busy, the running frame restarts the timer when it is coarse */
+    if (
+        _bFinished
+        && (_finishedFrame.decimation > 1)
+        && !_renderWatcher.isRunning()
+        )
+    {
+        GraphRasterizer::Frame frame = _finishedFrame;
+        frame.image = QImage();
+
+        startFrame(frame, false);
+    }
+}
+
+void AsyncGraphRenderer::startFrame(GraphRasterizer::Frame frame, bool bAllowCoarse)
+{
+    frame.decimation = 1;
+    frame.tileScale = _tileCache.tileScale(frame);
+
+    /* Remember direction of panning for prefetch */
+    const double keyCenter = frame.keyRange.center();
+    if (keyCenter > _lastKeyCenter)
+    {
+        _panDirection = 1;
+    }
+    else if (keyCenter < _lastKeyCenter)
+    {
+        _panDirection = -1;
+    }
+    else
+    {
+        _panDirection = 0;
+    }
+    _lastKeyCenter = keyCenter;
+
+    /* Only render tiles (or graphs of tiles) that aren't cached */
+    if (frame.tileScale > 0)
+    {
+        qint64 firstTile;
+        qint64 lastTile;
+        GraphRasterizer::tileRange(frame, &firstTile, &lastTile);
+
+        for (qint64 tileIdx = firstTile; tileIdx <= lastTile; tileIdx++)
+        {
+            frame.tiles.append(_tileCache.tile(frame.graphs, tileIdx));
+        }
+    }
+
+    /* Render coarse frame first when the full frame would exceed the budget */
+    _runningPointCount = GraphRasterizer::pointCount(frame);
+    if (
+        bAllowCoarse
+        && (_frameBudget > 0)
+        && (_nsPerPoint > 0)
+        )
+    {
+        const double estimatedTime = _runningPointCount * _nsPerPoint / 1e6; // in milliseconds
+        if (estimatedTime > _frameBudget)
+        {
+            frame.decimation = qCeil(estimatedTime / _frameBudget);
+        }
+    }
+
+    _refineTimer.stop();
+    _renderTimer.start();
+
+    _bPrefetching = false;
+    _runningFrame = frame;
+    _renderWatcher.setFuture(QtConcurrent::run(GraphRasterizer::render, frame));
+}
+
+/*!
+ * Render tiles next to the visible range in direction of panning, in both directions when not panning
+ */
+void AsyncGraphRenderer::startPrefetch()
+{
+    GraphRasterizer::Frame frame = _finishedFrame;
+    frame.image = QImage();
+
+    if (frame.tileScale <= 0)
+    {
+        return;
+    }
+
+    qint64 firstTile;
+    qint64 lastTile;
+    GraphRasterizer::tileRange(frame, &firstTile, &lastTile);
+
+    for (qint32 offset = 1; offset <= _cPrefetchTileCount; offset++)
+    {
+        if (_panDirection >= 0)
+        {
+            if (!_tileCache.contains(frame.graphs, lastTile + offset))
+            {
+                frame.tiles.append(_tileCache.tile(frame.graphs, lastTile + offset));
+            }
+        }
+
+        if (_panDirection <= 0)
+        {
+            if (!_tileCache.contains(frame.graphs, firstTile - offset))
+            {
+                frame.tiles.append(_tileCache.tile(frame.graphs, firstTile - offset));
+            }
+        }
+    }
+
+    if (!frame.tiles.isEmpty())
+    {
+        _runningPointCount = GraphRasterizer::pointCount(frame);
+        _renderTimer.start();
+
+        _bPrefetching = true;
+        _runningFrame = frame;
+        _renderWatcher.setFuture(QtConcurrent::run(GraphRasterizer::render, frame));
+    }
+}
+
+void AsyncGraphRenderer::drawFrame(QCPPainter *painter, const GraphRasterizer::Frame &frame) const
+{
+    if (frame.size.isEmpty())
+    {
+        return;
+    }
+
+    /* Image row 0 is one pixel row below the upper value of the range (see QCPAxis::coordToPixel) */
+    const double topValue = frame.valueRange.lower + frame.valueRange.size() * (frame.size.height() - 1) / frame.size.height();
+    const double bottomValue = frame.valueRange.lower - frame.valueRange.size() / frame.size.height();
+
+    /* Map image on current axis ranges, image is outdated while a new frame is rendered */
+    const QRectF target(QPointF(_pKeyAxis->coordToPixel(frame.keyRange.lower), _pValueAxis->coordToPixel(topValue)),
+                        QPointF(_pKeyAxis->coordToPixel(frame.keyRange.upper), _pValueAxis->coordToPixel(bottomValue)));
+
+    painter->drawImage(target, frame.image);
+}
+
+/*!
+ * Pre-rendered scatter point, only rendered once for every combination of style, colour and size
+ */
+QImage AsyncGraphRenderer::scatterSprite(const QPen &pen, double size, double pixelRatio, bool bAntialiased) const
+{
+    const QString key = QString("%1_%2_%3_%4_%5").arg(pen.color().rgba()).arg(pen.widthF()).arg(size).arg(pixelRatio).arg(bAntialiased ? 1 : 0);
+
+    QHash<QString, QImage>::const_iterator it = _spriteCache.constFind(key);
+    if (it != _spriteCache.constEnd())
+    {
+        return it.value();
+    }
+
+    if (_spriteCache.size() >= _cMaxSpriteCount)
+    {
+        _spriteCache.clear();
+    }
+
+    const QImage sprite = GraphRasterizer::createScatterSprite(pen, size, pixelRatio, bAntialiased);
+    _spriteCache.insert(key, sprite);
+
+    return sprite;
+}
@@ -0,0 +1,95 @@
+#ifndef ASYNCGRAPHRENDERER_H
+#define ASYNCGRAPHRENDERER_H
+
+#include <QFutureWatcher>
+#include <QImage>
+#include <QTimer>
+#include <QElapsedTimer>
+#include "qcustomplot.h"
+#include "graphrasterizer.h"
+#include "tilecache.h"
+
+/*
+ * Draws the lines of all graphs that use external rendering (MyQCPGraph)
+ *
+ * Graph lines are rasterized into an image on a worker thread. During a replot, only the
+ * latest finished image is blitted, mapped on the current axis ranges when it is outdated.
+ * While a frame is being rendered, only the most recent request is kept, older requests are dropped.
+ * When a frame is finished, a new replot is queued to show it.
+ *
+ * Rendered tiles are kept in a TileCache, so panning mostly composites cached tiles.
+ * Images of unchanged graphs are reused as well: changing the style, visibility or order
+ * of a single graph only renders that graph again. When idle, tiles next to the visible
+ * range are prefetched in the direction of panning.
+ *
+ * When the estimated render time of a frame exceeds the frame budget, a coarse frame
+ * (only every nth point) is rendered first. The full frame replaces it when the view
+ * hasn't changed for a moment. The estimate is based on the measured time per point.
+ *
+ * In density mode, all graphs are combined in one colour-mapped density image.
+ * */
+class AsyncGraphRenderer : public QCPLayerable
+{
+    Q_OBJECT
+
+public:
+    explicit AsyncGraphRenderer(QCustomPlot * pPlot, QCPAxis * pKeyAxis, QCPAxis * pValueAxis, QReadWriteLock * pDataLock);
+    virtual ~AsyncGraphRenderer();
+
+    void setFrameBudget(qint32 budget);
+    void setDensityMode(bool bDensity);
+
+protected:
+    virtual QRect clipRect() const;
+    virtual void applyDefaultAntialiasingHint(QCPPainter *painter) const;
+    virtual void draw(QCPPainter *painter);
+
+private slots:
+    void frameFinished();
+    void refineFrame();
+
+private:
+    GraphRasterizer::Frame currentFrame(bool bAntialiased) const;
+    void requestFrame(const GraphRasterizer::Frame &frame);
+    void startFrame(GraphRasterizer::Frame frame, bool bAllowCoarse);
+    void startPrefetch();
+    void drawFrame(QCPPainter *painter, const GraphRasterizer::Frame &frame) const;
+    QImage scatterSprite(const QPen &pen, double size, double pixelRatio, bool bAntialiased) const;
+
+    QCPAxis * _pKeyAxis;
+    QCPAxis * _pValueAxis;
+    QReadWriteLock * _pDataLock;
+
+    bool _bDensity;
+
+    QFutureWatcher<GraphRasterizer::Frame> _renderWatcher;
+    GraphRasterizer::Frame _runningFrame;
+
+    GraphRasterizer::Frame _pendingFrame;
+    bool _bPending;
+
+    GraphRasterizer::Frame _finishedFrame;
+    bool _bFinished;
+
+    TileCache _tileCache;
+    bool _bPrefetching;
+    double _lastKeyCenter;
+    qint32 _panDirection;
+
+    qint32 _frameBudget; // in milliseconds, 0 disables coarse frames
+    QElapsedTimer _renderTimer;
+    qint64 _runningPointCount;
+    double _nsPerPoint; // 0 when not measured yet
+    QTimer _refineTimer;
+
+    mutable QHash<QString, QImage> _spriteCache; // scatter point per style
+
+    static const qint32 _cPrefetchTileCount = 2;
+    static const qint32 _cDefaultFrameBudget = 50; // in milliseconds
+    static const qint32 _cRefineDelay = 150; // in milliseconds
+    static const qint64 _cMinMeasurePointCount = 100000;
+    static const qint32 _cMaxSpriteCount = 256;
+
+};
+
+#endif // ASYNCGRAPHRENDERER_H
@@ -10,6 +10,9 @@
 #include "graphdatamodel.h"
 #include "myqcpaxistickertime.h"
 #include "myqcpaxis.h"
+#include "myqcpgraph.h"
+#include "asyncgraphrenderer.h"
+#include "framescheduler.h"
 #include "basicgraphview.h"
 
 BasicGraphView::BasicGraphView(GuiModel * pGuiModel, GraphDataModel * pGraphDataModel, MyQCustomPlot * pPlot, QObject *parent) :
@@ -20,11 +23,17 @@ BasicGraphView::BasicGraphView(GuiModel * pGuiModel, GraphDataModel * pGraphData
 
    _pPlot = pPlot;
 
+   // All replots are combined per display frame
+   _pFrameScheduler = new FrameScheduler(_pPlot, this);
+   connect(_pFrameScheduler, &FrameScheduler::cursorFrame, this, &BasicGraphView::cursorValueUpdate);
+
    /* Range drag is also enabled/disabled on mousePress and mouseRelease event */
    _pPlot->setInteractions(QCP::iRangeDrag | QCP::iRangeZoom | QCP::iSelectAxes);
 
-   // disable anti aliasing while dragging
-   _pPlot->setNoAntialiasingOnDrag(true);
+   /*
+    * Anti aliasing isn't disabled while dragging: graphs are rendered asynchronously
+    * and a different setting would invalidate all cached tiles while panning
+    * */
 
    /*
     * Greatly improves performance
@@ -55,13 +64,26 @@ BasicGraphView::BasicGraphView(GuiModel * pGuiModel, GraphDataModel * pGraphData
    _pPlot->yAxis->setRange(0, 65535);
 
    connect(_pPlot->xAxis, SIGNAL(rangeChanged(QCPRange, QCPRange)), this, SLOT(updateTooltip()));
+   connect(_pPlot->xAxis, SIGNAL(rangeChanged(QCPRange)), this, SLOT(xAxisRangeChanged(QCPRange)));
 
    // Samples are enabled
    _bEnableSampleHighlight = true;
+   _bSamplesHighlighted = false;
+   _bHighlightEnabledState = true;
+   _highlightGraphCount = 0;
+   _highlightDataSize = 0;
+   _highlightWidth = 0;
+
+   _eventGraphIdx = 0;
+   _eventIdx = -1;
+   _bEventsTruncated = false;
 
    // Add layer to move graph on front
    _pPlot->addLayer("topMain", _pPlot->layer("main"), QCustomPlot::limAbove);
 
+   // Graph lines are rasterized on a worker thread
+   _pGraphRenderer = new AsyncGraphRenderer(_pPlot, _pPlot->xAxis, _pPlot->yAxis, _pGraphDataModel->dataLock());
+
    // connect slot that ties some axis selections together (especially opposite axes):
    connect(_pPlot, SIGNAL(selectionChangedByUser()), this, SLOT(selectionChanged()));
 
@@ -76,17 +98,23 @@ BasicGraphView::BasicGraphView(GuiModel * pGuiModel, GraphDataModel * pGraphData
    QPen markerPen;
    markerPen.setWidth(2);
 
+   /*
+    * Markers are on the buffered overlay layer (also used for selection rect),
+    * so they can be repainted without replotting the graphs
+    * */
    markerPen.setColor(QColor(Qt::green));
    _pStartMarker = new QCPItemStraightLine(_pPlot);
+   _pStartMarker->setLayer("overlay");
    _pStartMarker->setVisible(false);
    _pStartMarker->setPen(markerPen);
 
    markerPen.setColor(QColor(Qt::red));
    _pEndMarker = new QCPItemStraightLine(_pPlot);
+   _pEndMarker->setLayer("overlay");
    _pEndMarker->setVisible(false);
    _pEndMarker->setPen(markerPen);
 
-   _pPlot->replot();
+   _pFrameScheduler->requestReplot();
 
 }
 
@@ -97,7 +125,24 @@ BasicGraphView::~BasicGraphView()
 
 qint32 BasicGraphView::graphDataSize()
 {
-    return _pPlot->graph(0)->data()->size();
+    return keyReference()->size();
+}
+
+/*!
+ * Data of a graph that holds the shared time axis (see updateGraphs)
+ * Placeholder graphs have no samples, so the first graph with samples is used
+ */
+QSharedPointer<QCPGraphDataContainer> BasicGraphView::keyReference()
+{
+    for (qint32 activeIdx = 0; activeIdx < _pPlot->graphCount(); activeIdx++)
+    {
+        if (!_pPlot->graph(activeIdx)->data()->isEmpty())
+        {
+            return _pPlot->graph(activeIdx)->data();
+        }
+    }
+
+    return _pPlot->graph(0)->data();
 }
 
 bool BasicGraphView::valuesUnderCursor(QList<double> &valueList)
@@ -111,26 +156,51 @@ bool BasicGraphView::valuesUnderCursor(QList<double> &valueList)
         QCPGraphDataContainer::const_iterator tooltipIt = getClosestPoint(xPos);
 
         bool bValid;
-        const QCPRange keyRange = _pPlot->graph(0)->data()->keyRange(bValid);
+        const QCPRange keyRange = keyReference()->keyRange(bValid);
 
-        // Check all graphs
-        for (qint32 activeGraphIndex = 0; activeGraphIndex < _pPlot->graphCount(); activeGraphIndex++)
+        if (
+                _pPlot->underMouse()
+                && bValid
+                && keyRange.contains(xPos)
+            )
         {
-            if (
-                    _pPlot->underMouse()
-                    && bValid
-                    && keyRange.contains(xPos)
-                )
+            /* All graphs share the time axis (see updateGraphs), so the index of the closest point is the same for every graph */
+            const qint32 sampleIdx = tooltipIt - keyReference()->constBegin();
+
+            valueList.reserve(_pPlot->graphCount());
+            for (qint32 activeGraphIndex = 0; activeGraphIndex < _pPlot->graphCount(); activeGraphIndex++)
             {
-                const qint32 graphIdx = _pGraphDataModel->convertToGraphIndex(activeGraphIndex);
-                QCPGraphDataContainer::const_iterator graphDataIt = _pGraphDataModel->dataMap(graphIdx).data()->findBegin(tooltipIt->key, false);
-                valueList.append(graphDataIt->value);
+                const MyQCPGraph * pGraph = static_cast<MyQCPGraph *>(_pPlot->graph(activeGraphIndex));
+                const QCPGraphDataContainer * pMap = pGraph->data().data();
+
+                if (
+                    (sampleIdx < pMap->size())
+                    && (pMap->at(sampleIdx)->key == tooltipIt->key)
+                    )
+                {
+                    valueList.append(pGraph->scaledValue(pMap->at(sampleIdx)->value));
+                }
+                else if (!pMap->isEmpty())
+                {
+                    valueList.append(pGraph->scaledValue(pMap->findBegin(tooltipIt->key, false)->value));
+                }
+                else if (pGraph->isPlaceholder())
+                {
+                    valueList.append(pGraph->scaledValue(pGraph->placeholderValue()));
+                }
+                else
+                {
+                    valueList.append(0);
+                }
             }
-            else
+        }
+        else
+        {
+            for (qint32 activeGraphIndex = 0; activeGraphIndex < _pPlot->graphCount(); activeGraphIndex++)
             {
                 valueList.append(0);
-                bRet = false;
             }
+            bRet = false;
         }
     }
     else
@@ -143,28 +213,71 @@ bool BasicGraphView::valuesUnderCursor(QList<double> &valueList)
 
 }
 
+/*!
+ * Search events in graph, \a value is in shown units (gain and offset applied)
+ * The first event is shown by showNextEvent, returns the number of events
+ */
+qint32 BasicGraphView::searchEvents(quint32 graphIdx, EventSearch::SearchType type, double value)
+{
+    const QCPRange fullRange(-QCPRange::maxRange, QCPRange::maxRange);
+    const EventSearch::Result result = EventSearch::search(_pGraphDataModel->dataMap(graphIdx, fullRange).data(),
+                                                           _pGraphDataModel->gain(graphIdx),
+                                                           _pGraphDataModel->offset(graphIdx),
+                                                           type, value, _cMaxEvents);
+
+    _eventGraphIdx = graphIdx;
+    _eventIndices = result.indices;
+    _bEventsTruncated = result.bTruncated;
+    _eventIdx = -1;
+
+    emit eventChanged();
+
+    return _eventIndices.size();
+}
+
+qint32 BasicGraphView::eventCount()
+{
+    return _eventIndices.size();
+}
+
+/*!
+ * Index of shown event, -1 when no event is shown yet
+ */
+qint32 BasicGraphView::currentEvent()
+{
+    return _eventIdx;
+}
+
+/*!
+ * Search stopped after _cMaxEvents events
+ */
+bool BasicGraphView::eventsTruncated()
+{
+    return _bEventsTruncated;
+}
+
 void BasicGraphView::manualScaleXAxis(qint64 min, qint64 max)
 {
     _pPlot->xAxis->setRange(min, max);
-    _pPlot->replot();
+    _pFrameScheduler->requestReplot();
 }
 
 void BasicGraphView::manualScaleYAxis(qint64 min, qint64 max)
 {
     _pPlot->yAxis->setRange(min, max);
-    _pPlot->replot();
+    _pFrameScheduler->requestReplot();
 }
 
 void BasicGraphView::autoScaleXAxis()
 {
     _pPlot->xAxis->rescale(true);
-    _pPlot->replot();
+    _pFrameScheduler->requestReplot();
 }
 
 void BasicGraphView::autoScaleYAxis()
 {
     _pPlot->yAxis->rescale(true);
-    _pPlot->replot();
+    _pFrameScheduler->requestReplot();
 }
 
 void BasicGraphView::updateTooltip()
@@ -175,7 +288,13 @@ void BasicGraphView::updateTooltip()
 void BasicGraphView::enableSamplePoints()
 {
     _bEnableSampleHighlight = _pGuiModel->highlightSamples();
-    _pPlot->replot();
+    _pFrameScheduler->requestReplot();
+}
+
+void BasicGraphView::enableDensityMode()
+{
+    _pGraphRenderer->setDensityMode(_pGuiModel->densityMode());
+    _pFrameScheduler->requestReplot();
 }
 
 void BasicGraphView::clearGraph(const quint32 graphIdx)
@@ -193,23 +312,36 @@ void BasicGraphView::clearGraph(const quint32 graphIdx)
         else if (activeGraphList.size() == 1)
         {
             /* Only one graph active: clear all data */
+            QWriteLocker locker(_pGraphDataModel->dataLock());
             _pGraphDataModel->dataMap(graphIdx)->clear();
+            _pGraphDataModel->dataIndex(graphIdx)->invalidate();
+            locker.unlock();
 
-            _pPlot->replot();
+            /* Filters of this graph follow */
+            _pGraphDataModel->updateFilterGraphs();
+
+            _pFrameScheduler->requestReplot();
         }
         else
         {
-            /* Several active graph, keep time data but clear data */
-            QCPGraphDataContainer::iterator it = _pGraphDataModel->dataMap(graphIdx)->begin();
+            /* Several active graph, keep time axis: replace samples by zero placeholder */
+            MyQCPGraph * pGraph = static_cast<MyQCPGraph *>(_pPlot->graph(_pGraphDataModel->convertToActiveGraphIndex(graphIdx)));
+
+            QWriteLocker locker(_pGraphDataModel->dataLock());
+            _pGraphDataModel->dataMap(graphIdx)->clear();
+            _pGraphDataModel->dataIndex(graphIdx)->invalidate();
+            locker.unlock();
 
-            /* Clear all values, keep keys */
-            while(it != _pGraphDataModel->dataMap(graphIdx)->end())
+            _pGraphDataModel->updateFilterGraphs();
+
+            bool bValid;
+            const QCPRange keyRange = keyReference()->keyRange(bValid);
+            if (bValid)
             {
-                it->value = 0u;
-                it++;
+                pGraph->setPlaceholder(GraphDataModel::cPlaceholderValue, keyRange);
             }
 
-            _pPlot->replot();
+            _pFrameScheduler->requestReplot();
         }
     }
 }
@@ -226,6 +358,7 @@ void BasicGraphView::updateGraphs()
     {
         // All graphs should have the same amount of points.
         // Loop over graphs and get maximum count of samples
+        // Graphs with less points are shown as zero placeholder over the time axis of the longest graph
         qint32 maxSampleCount = 0;
         quint32 maxSampleIdx = 0;
 
@@ -239,11 +372,14 @@ void BasicGraphView::updateGraphs()
             }
         }
 
-        // Graph that have less points will be zeroed with that amount of points
+        bool bReferenceValid = false;
+        const QCPRange referenceKeyRange = _pGraphDataModel->dataMap(maxSampleIdx)->keyRange(bReferenceValid);
+
         foreach(quint16 graphIdx, activeGraphList)
         {
             // Add graph
-            QCPGraph * pGraph = _pPlot->addGraph();
+            MyQCPGraph * pGraph = new MyQCPGraph(_pPlot->xAxis, _pPlot->yAxis);
+            pGraph->setExternalRendering(true);
 
             pGraph->setName(_pGraphDataModel->label(graphIdx));
 
@@ -253,31 +389,39 @@ void BasicGraphView::updateGraphs()
             pen.setCosmetic(true);
 
             pGraph->setPen(pen);
+            pGraph->setVisible(_pGraphDataModel->isVisible(graphIdx));
+            pGraph->setScaling(_pGraphDataModel->gain(graphIdx), _pGraphDataModel->offset(graphIdx));
 
 
             QSharedPointer<QCPGraphDataContainer> pMap = _pGraphDataModel->dataMap(graphIdx);
 
-            // Set data to zero when needed
+            // Replace by zero placeholder when needed, doesn't store a sample per key
             if (pMap->size() != maxSampleCount)
             {
-                const QSharedPointer<QCPGraphDataContainer> pReferenceMap = _pGraphDataModel->dataMap(maxSampleIdx);
-                pMap->clear();
+                if (!pMap->isEmpty())
+                {
+                    QWriteLocker locker(_pGraphDataModel->dataLock());
+                    pMap->clear();
 
-                // Add zero value for every key (x-coordinate)
-                QCPGraphDataContainer::const_iterator refIt = pReferenceMap->constBegin();
-                while(refIt != pReferenceMap->constEnd())
+                    _pGraphDataModel->dataIndex(graphIdx)->invalidate();
+                }
+
+                if (bReferenceValid)
                 {
-                    pMap->add(QCPGraphData(refIt->key, 0));
-                    refIt++;
+                    pGraph->setPlaceholder(GraphDataModel::cPlaceholderValue, referenceKeyRange);
                 }
             }
 
             // Set graph datamap
             pGraph->setData(pMap);
+            pGraph->setDataIndex(_pGraphDataModel->dataIndex(graphIdx));
         }
+
+        /* New graphs should follow current highlight state */
+        highlightSamples(_bSamplesHighlighted);
     }
 
-    _pPlot->replot();
+    _pFrameScheduler->requestReplot();
 }
 
 void BasicGraphView::changeGraphColor(const quint32 graphIdx)
@@ -293,7 +437,7 @@ void BasicGraphView::changeGraphColor(const quint32 graphIdx)
 
         _pPlot->graph(activeIdx)->setPen(pen);
 
-        _pPlot->replot();
+        _pFrameScheduler->requestReplot();
     }
 }
 
@@ -305,7 +449,7 @@ void BasicGraphView::changeGraphLabel(const quint32 graphIdx)
 
         _pPlot->graph(activeIdx)->setName(_pGraphDataModel->label(graphIdx));
 
-        _pPlot->replot();
+        _pFrameScheduler->requestReplot();
     }
 }
 
@@ -314,7 +458,7 @@ void BasicGraphView::bringToFront()
     if (_pPlot->graphCount() > 0)
     {
         _pPlot->graph(_pGuiModel->frontGraph())->setLayer("topMain");
-        _pPlot->replot();
+        _pFrameScheduler->requestReplot();
     }
 }
 
@@ -325,7 +469,7 @@ void BasicGraphView::updateMarkersVisibility()
         _pStartMarker->setVisible(false);
         _pEndMarker->setVisible(false);
 
-        _pPlot->replot();
+        _pFrameScheduler->requestReplot(FrameScheduler::cDirtyOverlay);
     }
 }
 
@@ -335,7 +479,7 @@ void BasicGraphView::setStartMarker()
     _pStartMarker->point1->setCoords(_pGuiModel->startMarkerPos(), 0);
     _pStartMarker->point2->setCoords(_pGuiModel->startMarkerPos(), 1);
 
-    _pPlot->replot();
+    _pFrameScheduler->requestReplot(FrameScheduler::cDirtyOverlay);
 }
 
 void BasicGraphView::setEndMarker()
@@ -344,7 +488,7 @@ void BasicGraphView::setEndMarker()
     _pEndMarker->point1->setCoords(_pGuiModel->endMarkerPos(), 0);
     _pEndMarker->point2->setCoords(_pGuiModel->endMarkerPos(), 1);
 
-    _pPlot->replot();
+    _pFrameScheduler->requestReplot(FrameScheduler::cDirtyOverlay);
 }
 
 void BasicGraphView::setOpenGl(bool bState)
@@ -357,6 +501,40 @@ bool BasicGraphView::openGl(void)
     return _pPlot->openGl();
 }
 
+/*!
+ * Maximum render time of a frame (in milliseconds), a coarse frame is shown first when it is exceeded
+ */
+void BasicGraphView::setFrameBudget(qint32 budget)
+{
+    _pGraphRenderer->setFrameBudget(budget);
+}
+
+/*!
+ * More samples of filter graphs are calculated in the background
+ */
+void BasicGraphView::updateFilterData()
+{
+    _pFrameScheduler->requestReplot();
+}
+
+void BasicGraphView::showNextEvent()
+{
+    if (!_eventIndices.isEmpty())
+    {
+        _eventIdx = qMin(_eventIdx + 1, _eventIndices.size() - 1);
+        moveToEvent();
+    }
+}
+
+void BasicGraphView::showPreviousEvent()
+{
+    if (!_eventIndices.isEmpty())
+    {
+        _eventIdx = qMax(_eventIdx - 1, 0);
+        moveToEvent();
+    }
+}
+
 void BasicGraphView::selectionChanged()
 {
    /*
@@ -482,9 +660,10 @@ void BasicGraphView::mouseMove(QMouseEvent *event)
     {
         paintTimeStampToolTip(event->pos());
 
+        /* Legend is updated at most once per frame */
         if (_pGuiModel->cursorValues())
         {
-            emit cursorValueUpdate();
+            _pFrameScheduler->requestReplot(FrameScheduler::cDirtyCursor);
         }
     }
 }
@@ -499,7 +678,7 @@ void BasicGraphView::paintTimeStampToolTip(QPoint pos)
         QCPGraphDataContainer::const_iterator tooltipIt = getClosestPoint(xPos);
 
         bool bValid;
-        const QCPRange keyRange = _pPlot->graph(0)->data()->keyRange(bValid);
+        const QCPRange keyRange = keyReference()->keyRange(bValid);
 
         if (bValid && keyRange.contains(xPos))
         {
@@ -526,6 +705,26 @@ void BasicGraphView::paintTimeStampToolTip(QPoint pos)
 
 void BasicGraphView::handleSamplePoints()
 {
+    const qint32 dataSize = (_pPlot->graphCount() > 0) ? graphDataSize() : 0;
+
+    /* Skip when nothing changed since last replot */
+    if (
+        (_pPlot->xAxis->range() == _highlightXRange)
+        && (_pPlot->graphCount() == _highlightGraphCount)
+        && (dataSize == _highlightDataSize)
+        && (_pPlot->axisRect()->width() == _highlightWidth)
+        && (_bEnableSampleHighlight == _bHighlightEnabledState)
+        )
+    {
+        return;
+    }
+
+    _highlightXRange = _pPlot->xAxis->range();
+    _highlightGraphCount = _pPlot->graphCount();
+    _highlightDataSize = dataSize;
+    _highlightWidth = _pPlot->axisRect()->width();
+    _bHighlightEnabledState = _bEnableSampleHighlight;
+
     bool bHighlight = false;
 
     if (_bEnableSampleHighlight)
@@ -534,8 +733,9 @@ void BasicGraphView::handleSamplePoints()
         {
             QCPRange axisRange = _pPlot->xAxis->range();
 
-            auto lowerBoundIt = _pPlot->graph(0)->data()->findBegin(axisRange.lower, false);
-            auto upperBoundIt = _pPlot->graph(0)->data()->findBegin(axisRange.upper);
+            QSharedPointer<QCPGraphDataContainer> pKeyReference = keyReference();
+            auto lowerBoundIt = pKeyReference->findBegin(axisRange.lower, false);
+            auto upperBoundIt = pKeyReference->findBegin(axisRange.upper);
 
             const int pointCount = upperBoundIt - lowerBoundIt;
 
@@ -554,18 +754,37 @@ void BasicGraphView::handleSamplePoints()
                 nrOfPixelsPerPoint = sizePx;
             }
 
-            if (nrOfPixelsPerPoint > _cPixelPerPointThreshold)
+            /* Hysteresis: zooming around the threshold doesn't toggle the highlight on every step */
+            if (_bSamplesHighlighted)
+            {
+                bHighlight = nrOfPixelsPerPoint > _cPixelPerPointThresholdOff;
+            }
+            else
             {
-                bHighlight = true;
+                bHighlight = nrOfPixelsPerPoint > _cPixelPerPointThreshold;
             }
 
         }
     }
 
-    /* TODO: add hysteresis to highlight sample points */
     highlightSamples(bHighlight);
 }
 
+void BasicGraphView::xAxisRangeChanged(const QCPRange &newRange)
+{
+    /* Filter graphs are calculated for the visible range */
+    if (_pGraphDataModel->setFilterKeyRange(newRange))
+    {
+        _pFrameScheduler->requestReplot();
+    }
+
+    /* Follow visible window with value axis */
+    if (_pGuiModel->yAxisScalingMode() == SCALE_WINDOW_AUTO)
+    {
+        static_cast<MyQCPAxis *>(_pPlot->yAxis)->rescaleValue(newRange);
+    }
+}
+
 void BasicGraphView::axisDoubleClicked(QCPAxis * axis)
 {
     if (axis == _pPlot->xAxis)
@@ -584,17 +803,25 @@ void BasicGraphView::axisDoubleClicked(QCPAxis * axis)
 
 void BasicGraphView::highlightSamples(bool bState)
 {
+    const QCPScatterStyle::ScatterShape shape = bState ? QCPScatterStyle::ssCircle : QCPScatterStyle::ssNone;
+
     for (qint32 graphIndex = 0; graphIndex < _pPlot->graphCount(); graphIndex++)
     {
-        if (bState)
+        /* Only touch graphs that need a different style */
+        if (_pPlot->graph(graphIndex)->scatterStyle().shape() != shape)
         {
-            _pPlot->graph(graphIndex)->setScatterStyle(QCPScatterStyle(QCPScatterStyle::ssCircle, 4));
-        }
-        else
-        {
-            _pPlot->graph(graphIndex)->setScatterStyle(QCPScatterStyle(QCPScatterStyle::ssNone));
+            if (bState)
+            {
+                _pPlot->graph(graphIndex)->setScatterStyle(QCPScatterStyle(QCPScatterStyle::ssCircle, 4));
+            }
+            else
+            {
+                _pPlot->graph(graphIndex)->setScatterStyle(QCPScatterStyle(QCPScatterStyle::ssNone));
+            }
         }
     }
+
+    _bSamplesHighlighted = bState;
 }
 
 qint32 BasicGraphView::graphIndex(QCPGraph * pGraph)
@@ -615,11 +842,12 @@ qint32 BasicGraphView::graphIndex(QCPGraph * pGraph)
 
 QCPGraphDataContainer::const_iterator BasicGraphView::getClosestPoint(double xPos)
 {
-    QCPGraphDataContainer::const_iterator closestIt = _pPlot->graph(0)->data()->constBegin();
-    QCPGraphDataContainer::const_iterator leftIt = _pPlot->graph(0)->data()->findBegin(xPos);
+    QSharedPointer<QCPGraphDataContainer> pKeyReference = keyReference();
+    QCPGraphDataContainer::const_iterator closestIt = pKeyReference->constBegin();
+    QCPGraphDataContainer::const_iterator leftIt = pKeyReference->findBegin(xPos);
 
     auto rightIt = leftIt + 1;
-    if (rightIt !=  _pPlot->graph(0)->data()->constEnd())
+    if (rightIt !=  pKeyReference->constEnd())
     {
 
         const double diffReference = rightIt->key - leftIt->key;
@@ -641,3 +869,43 @@ QCPGraphDataContainer::const_iterator BasicGraphView::getClosestPoint(double xPo
 
     return closestIt;
 }
+
+/*!
+ * Center x-axis on current event, keeping the zoom level
+ * The markers are set on the samples before and at the event
+ */
+void BasicGraphView::moveToEvent()
+{
+    if (_eventGraphIdx >= static_cast<quint32>(_pGraphDataModel->size()))
+    {
+        return;
+    }
+
+    QSharedPointer<QCPGraphDataContainer> pDataMap = _pGraphDataModel->dataMap(_eventGraphIdx);
+    const qint32 sampleIdx = _eventIndices[_eventIdx];
+
+    if (sampleIdx < pDataMap->size())
+    {
+        const double key = pDataMap->at(sampleIdx)->key;
+
+        /* Markers span the step into the event, the first sample has no previous sample so the step to the next one is used */
+        const qint32 otherIdx = sampleIdx > 0 ? sampleIdx - 1 : qMin(1, pDataMap->size() - 1);
+        const double otherKey = pDataMap->at(otherIdx)->key;
+
+        _pGuiModel->setxAxisScale(SCALE_MANUAL);
+        _pPlot->xAxis->setRange(key, _pPlot->xAxis->range().size(), Qt::AlignCenter);
+
+        /* Markers can't be set on the position of the other marker, so clear them first */
+        _pGuiModel->clearMarkersState();
+        _pGuiModel->setStartMarkerPos(qMin(key, otherKey));
+
+        if (otherIdx != sampleIdx)
+        {
+            _pGuiModel->setEndMarkerPos(qMax(key, otherKey));
+        }
+
+        _pFrameScheduler->requestReplot();
+    }
+
+    emit eventChanged();
+}
@@ -3,11 +3,14 @@
 
 #include <QObject>
 #include "myqcustomplot.h"
+#include "eventsearch.h"
 
 
 /* forward declaration */
 class GuiModel;
 class GraphDataModel;
+class AsyncGraphRenderer;
+class FrameScheduler;
 
 class BasicGraphView : public QObject
 {
@@ -27,8 +30,14 @@ public:
     virtual ~BasicGraphView();
 
     qint32 graphDataSize();
+    QSharedPointer<QCPGraphDataContainer> keyReference();
     bool valuesUnderCursor(QList<double> &valueList);
 
+    qint32 searchEvents(quint32 graphIdx, EventSearch::SearchType type, double value);
+    qint32 eventCount();
+    qint32 currentEvent();
+    bool eventsTruncated();
+
 public slots:
 
     virtual void manualScaleXAxis(qint64 min, qint64 max);
@@ -39,6 +48,7 @@ public slots:
 
     virtual void updateTooltip();
     virtual void enableSamplePoints();
+    virtual void enableDensityMode();
     virtual void clearGraph(const quint32 graphIdx);
     virtual void updateGraphs();
     virtual void changeGraphColor(const quint32 graphIdx);
@@ -49,9 +59,14 @@ public slots:
     virtual void setEndMarker();
     virtual void setOpenGl(bool bState);
     virtual bool openGl(void);
+    virtual void setFrameBudget(qint32 budget);
+    virtual void updateFilterData();
+    virtual void showNextEvent();
+    virtual void showPreviousEvent();
 
 signals:
     void cursorValueUpdate();
+    void eventChanged(); // When events are searched or another event is shown
 
 private slots:
     void selectionChanged();
@@ -63,6 +78,7 @@ private slots:
 
 protected slots:
     virtual void handleSamplePoints();
+    virtual void xAxisRangeChanged(const QCPRange &newRange);
     virtual void axisDoubleClicked(QCPAxis * axis);
 
 protected:
@@ -71,19 +87,38 @@ protected:
     GuiModel * _pGuiModel;
     GraphDataModel * _pGraphDataModel;
     MyQCustomPlot * _pPlot;
+    AsyncGraphRenderer * _pGraphRenderer;
+    FrameScheduler * _pFrameScheduler;
     bool _bEnableSampleHighlight;
 
 private:
     void highlightSamples(bool bState);
     qint32 graphIndex(QCPGraph * pGraph);
     QCPGraphDataContainer::const_iterator getClosestPoint(double xPos);
+    void moveToEvent();
 
     QVector<QString> tickLabels;
 
     QCPItemStraightLine * _pStartMarker;
     QCPItemStraightLine * _pEndMarker;
 
+    /* Inputs of last sample highlight check */
+    QCPRange _highlightXRange;
+    qint32 _highlightGraphCount;
+    qint32 _highlightDataSize;
+    qint32 _highlightWidth;
+    bool _bHighlightEnabledState;
+    bool _bSamplesHighlighted;
+
+    /* Result of last event search */
+    quint32 _eventGraphIdx;
+    QVector<qint32> _eventIndices;
+    qint32 _eventIdx; // -1 when no event is shown yet
+    bool _bEventsTruncated;
+
     static const qint32 _cPixelPerPointThreshold = 5; /* in pixels */
+    static const qint32 _cPixelPerPointThresholdOff = 4; /* in pixels, lower to add hysteresis */
+    static const qint32 _cMaxEvents = 100000;
 
 };
 
@@ -2,12 +2,19 @@
 #include "util.h"
 #include "guimodel.h"
 #include "graphdatamodel.h"
+#include "myqcpaxis.h"
+#include "myqcpgraph.h"
+#include "asyncgraphrenderer.h"
+#include "framescheduler.h"
 #include "extendedgraphview.h"
 
 ExtendedGraphView::ExtendedGraphView(GuiModel * pGuiModel, GraphDataModel * pRegisterDataModel, MyQCustomPlot *pPlot, QObject *parent):
     BasicGraphView(pGuiModel, pRegisterDataModel, pPlot)
 {
     Q_UNUSED(parent);
+
+    _bSlidingWindow = false;
+    _slidingWindowSize = 0;
 }
 
 ExtendedGraphView::~ExtendedGraphView()
@@ -15,12 +22,19 @@ ExtendedGraphView::~ExtendedGraphView()
 
 }
 
-void ExtendedGraphView::addData(QList<double> timeData, QList<QList<double> > data)
+/*!
+ * Show new data, the first \a unchangedCount samples of every graph are the same as before
+ */
+void ExtendedGraphView::addData(QList<double> timeData, QList<QList<double> > data, qint32 unchangedCount)
 {
-    _pGuiModel->setxAxisScale(BasicGraphView::SCALE_AUTO);
+    /* Sliding window keeps following new data */
+    if (_pGuiModel->xAxisScalingMode() != BasicGraphView::SCALE_SLIDING)
+    {
+        _pGuiModel->setxAxisScale(BasicGraphView::SCALE_AUTO);
+    }
     _pGuiModel->setyAxisScale(BasicGraphView::SCALE_AUTO);
 
-    updateData(&timeData, &data);
+    updateData(&timeData, &data, unchangedCount);
 }
 
 void ExtendedGraphView::showGraph(quint32 graphIdx)
@@ -37,10 +51,56 @@ void ExtendedGraphView::showGraph(quint32 graphIdx)
     }
 }
 
+/*!
+ * Gain or offset of graph has changed: only a replot is needed, the data isn't touched
+ */
+void ExtendedGraphView::changeGraphScaling(quint32 graphIdx)
+{
+    if (_pGraphDataModel->isActive(graphIdx))
+    {
+        const quint32 activeIdx = _pGraphDataModel->convertToActiveGraphIndex(graphIdx);
+
+        static_cast<MyQCPGraph *>(_pPlot->graph(activeIdx))->setScaling(_pGraphDataModel->gain(graphIdx), _pGraphDataModel->offset(graphIdx));
+
+        rescalePlot();
+    }
+}
+
+/*!
+ * Apply visibility, label, color and scaling of all graphs after a batch of changes in the model
+ * The plot is only rescaled once
+ */
+void ExtendedGraphView::updateGraphProperties()
+{
+    for (qint32 activeIdx = 0; activeIdx < _pGraphDataModel->activeCount(); activeIdx++)
+    {
+        const quint32 graphIdx = _pGraphDataModel->convertToGraphIndex(activeIdx);
+        MyQCPGraph * pGraph = static_cast<MyQCPGraph *>(_pPlot->graph(activeIdx));
+
+        pGraph->setVisible(_pGraphDataModel->isVisible(graphIdx));
+        pGraph->setName(_pGraphDataModel->label(graphIdx));
+        pGraph->setScaling(_pGraphDataModel->gain(graphIdx), _pGraphDataModel->offset(graphIdx));
+
+        if (pGraph->pen().color() != _pGraphDataModel->color(graphIdx))
+        {
+            QPen pen = pGraph->pen();
+            pen.setColor(_pGraphDataModel->color(graphIdx));
+            pGraph->setPen(pen);
+        }
+    }
+
+    rescalePlot();
+}
+
 void ExtendedGraphView::rescalePlot()
 {
 
     // scale x-axis
+    if (_pGuiModel->xAxisScalingMode() != SCALE_SLIDING)
+    {
+        _bSlidingWindow = false;
+    }
+
     if (_pGuiModel->xAxisScalingMode() == SCALE_AUTO)
     {
         if ((_pPlot->graphCount() != 0) && (graphDataSize() != 0))
@@ -54,7 +114,7 @@ void ExtendedGraphView::rescalePlot()
     }
     else if (_pGuiModel->xAxisScalingMode() == SCALE_SLIDING)
     {
-        _pPlot->xAxis->rescale(true);
+        slideXAxis();
     }
     else // Manual
     {
@@ -79,50 +139,133 @@ void ExtendedGraphView::rescalePlot()
     }
     else if (_pGuiModel->yAxisScalingMode() == SCALE_WINDOW_AUTO)
     {
-        _pPlot->yAxis->rescale(true);
+        static_cast<MyQCPAxis *>(_pPlot->yAxis)->rescaleValue(_pPlot->xAxis->range());
     }
     else // Manual
     {
 
     }
 
-    _pPlot->replot();
+    _pFrameScheduler->requestReplot();
 }
 
 void ExtendedGraphView::clearResults()
 {
+    QWriteLocker locker(_pGraphDataModel->dataLock());
+
     for (qint32 i = 0; i < _pPlot->graphCount(); i++)
     {
         _pPlot->graph(i)->data()->clear();
+        _pGraphDataModel->dataIndex(_pGraphDataModel->convertToGraphIndex(i))->invalidate();
+        static_cast<MyQCPGraph *>(_pPlot->graph(i))->clearPlaceholder();
         _pPlot->graph(i)->setName(QString("(-) %1").arg(_pGraphDataModel->label(i)));
     }
 
+    locker.unlock();
+
    rescalePlot();
 }
 
-void ExtendedGraphView::updateData(QList<double> *pTimeData, QList<QList<double> > * pDataLists)
+void ExtendedGraphView::updateData(QList<double> *pTimeData, QList<QList<double> > * pDataLists, qint32 unchangedCount)
 {
     quint64 totalPoints = 0;
     const QVector<double> timeData = pTimeData->toVector();
 
+    /* Wait until render thread has finished reading the data */
+    QWriteLocker locker(_pGraphDataModel->dataLock());
+
     for (qint32 i = 1; i < pDataLists->size(); i++)
     {
         //Add data to graphs
         QVector<double> graphData = pDataLists->at(i).toVector();
-        _pPlot->graph(i - 1)->setData(timeData, graphData);
+        MyQCPGraph * pGraph = static_cast<MyQCPGraph *>(_pPlot->graph(i - 1));
+        QSharedPointer<QCPGraphDataContainer> pMap = pGraph->data();
+        const qint32 presentCount = pMap->size();
+
+        /* Present samples after the unchanged rows are read again, they can be updated in place when their keys are the same */
+        const qint32 changedBegin = qMin(unchangedCount, presentCount);
+        bool bSameKeys = presentCount <= timeData.size();
+        for (qint32 sampleIdx = changedBegin; bSameKeys && (sampleIdx < presentCount); sampleIdx++)
+        {
+            bSameKeys = (pMap->constBegin() + sampleIdx)->key == timeData[sampleIdx];
+        }
+
+        if (pGraph->isPlaceholder())
+        {
+            // Keep placeholder value for keys it covers, only samples after it are real data
+            const double placeholderEnd = pGraph->placeholderKeyRange().upper;
+
+            if (!timeData.isEmpty() && (timeData.last() > placeholderEnd))
+            {
+                QVector<QCPGraphData> newData(timeData.size());
+
+                for (qint32 sampleIdx = 0; sampleIdx < timeData.size(); sampleIdx++)
+                {
+                    const double value = timeData[sampleIdx] <= placeholderEnd ? pGraph->placeholderValue() : graphData[sampleIdx];
+                    newData[sampleIdx] = QCPGraphData(timeData[sampleIdx], value);
+                }
+
+                pMap->set(newData, true);
+                pGraph->clearPlaceholder();
+
+                _pGraphDataModel->dataIndex(_pGraphDataModel->convertToGraphIndex(i - 1))->invalidate();
+            }
+        }
+        else if (
+            (presentCount > 0)
+            && (unchangedCount > 0)
+            && bSameKeys
+            )
+        {
+            // Only update values of changed samples and add new samples (keeps graph index valid)
+            QCPGraphDataContainer::iterator it = pMap->begin() + changedBegin;
+            for (qint32 sampleIdx = changedBegin; sampleIdx < presentCount; sampleIdx++, it++)
+            {
+                it->value = graphData[sampleIdx];
+            }
+
+            _pGraphDataModel->dataIndex(_pGraphDataModel->convertToGraphIndex(i - 1))->invalidate(changedBegin, presentCount);
+
+            QVector<QCPGraphData> newData;
+            newData.reserve(timeData.size() - presentCount);
+
+            for (qint32 sampleIdx = presentCount; sampleIdx < timeData.size(); sampleIdx++)
+            {
+                newData.append(QCPGraphData(timeData[sampleIdx], graphData[sampleIdx]));
+            }
+
+            pMap->add(newData, true);
+        }
+        else
+        {
+            _pPlot->graph(i - 1)->setData(timeData, graphData);
+
+            _pGraphDataModel->dataIndex(_pGraphDataModel->convertToGraphIndex(i - 1))->invalidate();
+        }
 
         totalPoints += graphData.size();
     }
 
+    locker.unlock();
+
+    // Derived and filter graphs are calculated from the new data, the renderer follows their data revision
+    _pGraphDataModel->updateDerivedGraphs();
+    _pGraphDataModel->updateFilterGraphs();
+
     // Check if optimizations are needed
     if (totalPoints > _cOptimizeThreshold)
     {
         _pGuiModel->setHighlightSamples(false);
 
-        // Set width to 1
+        // Set width to 1 (allows fast line rasterizer)
         for (qint32 i = 0; i <  _pPlot->graphCount(); i++)
         {
-             _pPlot->graph(i)->pen().setWidth(1);
+            QPen pen = _pPlot->graph(i)->pen();
+            if (pen.widthF() > 1)
+            {
+                pen.setWidth(1);
+                _pPlot->graph(i)->setPen(pen);
+            }
         }
 
         // Disable anti aliasing
@@ -132,7 +275,7 @@ void ExtendedGraphView::updateData(QList<double> *pTimeData, QList<QList<double>
     // Rescale only axis that are in auto scale mode
     if (
         (_pGuiModel->xAxisScalingMode() == SCALE_AUTO)
-        && (_pGuiModel->xAxisScalingMode() == SCALE_AUTO)
+        && (_pGuiModel->yAxisScalingMode() == SCALE_AUTO)
     )
     {
         _pPlot->rescaleAxes(true);
@@ -141,10 +284,54 @@ void ExtendedGraphView::updateData(QList<double> *pTimeData, QList<QList<double>
     {
         _pPlot->xAxis->rescale(true);
     }
-    else if (_pGuiModel->yAxisScalingMode() == SCALE_AUTO)
+    else
+    {
+        if (_pGuiModel->xAxisScalingMode() == SCALE_SLIDING)
+        {
+            slideXAxis();
+        }
+
+        if (_pGuiModel->yAxisScalingMode() == SCALE_AUTO)
+        {
+           _pPlot->yAxis->rescale(true);
+        }
+    }
+
+    _pFrameScheduler->requestReplot();
+}
+
+/*!
+ * Move x-axis window to end of data, keeping the size of the window when sliding was started
+ * Keeping the exact size keeps the zoom level, so the renderer only draws the tiles with new data
+ */
+void ExtendedGraphView::slideXAxis()
+{
+    if (!_bSlidingWindow)
+    {
+        _slidingWindowSize = _pPlot->xAxis->range().size();
+        _bSlidingWindow = true;
+    }
+
+    bool bFound = false;
+    double lastKey = 0;
+
+    for (qint32 graphIdx = 0; graphIdx < _pPlot->graphCount(); graphIdx++)
     {
-       _pPlot->yAxis->rescale(true);
+        QSharedPointer<QCPGraphDataContainer> pMap = _pPlot->graph(graphIdx)->data();
+
+        if (
+            _pPlot->graph(graphIdx)->visible()
+            && !pMap->isEmpty()
+            )
+        {
+            const double graphLastKey = (pMap->constEnd() - 1)->key;
+            lastKey = bFound ? qMax(lastKey, graphLastKey) : graphLastKey;
+            bFound = true;
+        }
     }
 
-    _pPlot->replot();
+    if (bFound)
+    {
+        _pPlot->xAxis->setRange(lastKey - _slidingWindowSize, lastKey);
+    }
 }
@@ -13,8 +13,10 @@ public:
     virtual ~ExtendedGraphView();
 
 public slots:
-    void addData(QList<double> timeData, QList<QList<double> > data);
+    void addData(QList<double> timeData, QList<QList<double> > data, qint32 unchangedCount = 0);
     void showGraph(quint32 graphIdx);
+    void updateGraphProperties();
+    void changeGraphScaling(quint32 graphIdx);
     void rescalePlot();
     void clearResults();
 
@@ -22,11 +24,16 @@ signals:
     void dataAddedToPlot(double timeData, QList<double> dataList);
 
 private slots:
-    void updateData(QList<double> *pTimeData, QList<QList<double> > * pDataLists);
+    void updateData(QList<double> *pTimeData, QList<QList<double> > * pDataLists, qint32 unchangedCount);
 
 private:
+    void slideXAxis();
+
     static const quint64 _cOptimizeThreshold = 1000000uL;
 
+    bool _bSlidingWindow;
+    double _slidingWindowSize;
+
     qint32 _diffWithUtc;
 
 };
@@ -0,0 +1,77 @@
+#include <QGuiApplication>
+#include <QScreen>
+
+#include "qcustomplot.h"
+#include "framescheduler.h"
+
+const quint32 FrameScheduler::cDirtyOverlay = 1 << 0;
+const quint32 FrameScheduler::cDirtyPlot    = 1 << 1;
+const quint32 FrameScheduler::cDirtyCursor  = 1 << 2;
+
+FrameScheduler::FrameScheduler(QCustomPlot * pPlot, QObject *parent) :
+    QObject(parent)
+{
+    _pPlot = pPlot;
+    _dirtyMask = 0;
+
+    /* Follow refresh rate of screen */
+    _frameInterval = _cDefaultFrameInterval;
+    if (
+        (QGuiApplication::primaryScreen() != NULL)
+        && (QGuiApplication::primaryScreen()->refreshRate() > 0)
+        )
+    {
+        _frameInterval = qMax(1, qRound(1000 / QGuiApplication::primaryScreen()->refreshRate()));
+    }
+
+    _frameTimer.setSingleShot(true);
+    connect(&_frameTimer, &QTimer::timeout, this, &FrameScheduler::frameTimeout);
+}
+
+/*!
+ * Request a replot of the complete plot, or only of the overlay layer when \a dirtyMask is cDirtyOverlay
+ * The replot is postponed until the next frame. With cDirtyCursor, cursorFrame() is emitted in the next frame.
+ */
+void FrameScheduler::requestReplot(quint32 dirtyMask)
+{
+    _dirtyMask |= dirtyMask;
+
+    if (!_frameTimer.isActive())
+    {
+        qint32 delay = 0;
+
+        if (_lastFrameTimer.isValid())
+        {
+            delay = qMax(0, _frameInterval - static_cast<qint32>(_lastFrameTimer.elapsed()));
+        }
+
+        /* Even without delay, requests of the current event loop iteration are combined */
+        _frameTimer.start(delay);
+    }
+}
+
+void FrameScheduler::frameTimeout()
+{
+    const quint32 dirtyMask = _dirtyMask;
+    _dirtyMask = 0;
+
+    _lastFrameTimer.start();
+
+    if (dirtyMask & cDirtyPlot)
+    {
+        _pPlot->replot();
+    }
+    else if (dirtyMask & cDirtyOverlay)
+    {
+        _pPlot->layer("overlay")->replot();
+    }
+    else
+    {
+        // Nothing to do
+    }
+
+    if (dirtyMask & cDirtyCursor)
+    {
+        emit cursorFrame();
+    }
+}
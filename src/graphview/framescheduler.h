@@ -0,0 +1,52 @@
+#ifndef FRAMESCHEDULER_H
+#define FRAMESCHEDULER_H
+
+#include <QObject>
+#include <QTimer>
+#include <QElapsedTimer>
+
+/* forward declaration */
+class QCustomPlot;
+
+/*
+ * Coalesces replot requests to at most one replot per display frame
+ *
+ * Requests mark the plot (or only the overlay layer) as dirty. The replot is
+ * done at the start of the next frame, all requests in between are combined.
+ * Cursor value updates (cDirtyCursor) are throttled the same way, cursorFrame() is
+ * emitted at most once per frame.
+ * */
+class FrameScheduler : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit FrameScheduler(QCustomPlot * pPlot, QObject *parent = 0);
+
+    void requestReplot(quint32 dirtyMask = cDirtyPlot);
+
+    static const quint32 cDirtyOverlay;
+    static const quint32 cDirtyPlot;
+    static const quint32 cDirtyCursor;
+
+signals:
+    void cursorFrame();
+
+private slots:
+    void frameTimeout();
+
+private:
+
+    QCustomPlot * _pPlot;
+
+    QTimer _frameTimer;
+    QElapsedTimer _lastFrameTimer;
+    qint32 _frameInterval; // in milliseconds
+
+    quint32 _dirtyMask;
+
+    static const qint32 _cDefaultFrameInterval = 16;
+
+};
+
+#endif // FRAMESCHEDULER_H
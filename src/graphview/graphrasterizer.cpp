@@ -0,0 +1,781 @@
+#include <QPainter>
+#include <QThread>
+#include <QtConcurrent>
+#include <QtMath>
+
+#include <cmath> // std::floor
+
+#include "graphrasterizer.h"
+
+/* Points far outside of the image are clamped, the raster engine can't handle huge coordinates */
+const double GraphRasterizer::_cCoordinateLimit = 1e6;
+
+/*!
+ * Call \a fillSpan(column, firstRow, lastRow) for every pixel column that the polyline
+ * \a pPoints crosses (logical coordinates), only for pixels inside \a pixelSize
+ *
+ * Every segment is split in one vertical span per pixel column it crosses. Dense
+ * graphs are mostly vertical segments, which results in a single tight loop.
+ */
+template <typename SpanFunction>
+void GraphRasterizer::rasterizeSegments(const QPointF * pPoints, qint32 count, double pixelRatio, const QSize &pixelSize, SpanFunction fillSpan)
+{
+    const qint32 width = pixelSize.width();
+    const qint32 height = pixelSize.height();
+
+    auto span = [&](qint32 column, double top, double bottom)
+    {
+        const qint32 firstRow = qMax(qFloor(top + 0.5), 0);
+        const qint32 lastRow = qMin(qFloor(bottom + 0.5), height - 1);
+
+        if (
+            (column >= 0)
+            && (column < width)
+            && (firstRow <= lastRow)
+            )
+        {
+            fillSpan(column, firstRow, lastRow);
+        }
+    };
+
+    if (count == 1)
+    {
+        const double y = pPoints[0].y() * pixelRatio;
+        span(qFloor(pPoints[0].x() * pixelRatio), y, y);
+    }
+
+    for (qint32 idx = 1; idx < count; idx++)
+    {
+        double x0 = pPoints[idx - 1].x() * pixelRatio;
+        double y0 = pPoints[idx - 1].y() * pixelRatio;
+        double x1 = pPoints[idx].x() * pixelRatio;
+        double y1 = pPoints[idx].y() * pixelRatio;
+
+        if (x1 < x0)
+        {
+            qSwap(x0, x1);
+            qSwap(y0, y1);
+        }
+
+        const qint32 firstColumn = qFloor(x0);
+        const qint32 lastColumn = qFloor(x1);
+
+        if (firstColumn == lastColumn)
+        {
+            span(firstColumn, qMin(y0, y1), qMax(y0, y1));
+        }
+        else
+        {
+            const double slope = (y1 - y0) / (x1 - x0);
+
+            /* Only columns inside the image */
+            const qint32 startColumn = qMax(firstColumn, 0);
+            const qint32 endColumn = qMin(lastColumn, width - 1);
+
+            for (qint32 column = startColumn; column <= endColumn; column++)
+            {
+                /* Part of segment inside this column */
+                const double yLeft = y0 + (qMax(x0, static_cast<double>(column)) - x0) * slope;
+                const double yRight = y0 + (qMin(x1, static_cast<double>(column + 1)) - x0) * slope;
+
+                span(column, qMin(yLeft, yRight), qMax(yLeft, yRight));
+            }
+        }
+    }
+}
+
+/*!
+ * Render all tiles of \a frame that aren't rendered yet and composite the visible tiles
+ * in a transparent image with the size of the axis rect
+ *
+ * Thread-safe: only reads from the data containers while holding the data lock
+ */
+GraphRasterizer::Frame GraphRasterizer::render(Frame frame)
+{
+    frame.image = createImage(frame.size, frame.pixelRatio);
+
+    if (
+        frame.image.isNull()
+        || (frame.tileScale <= 0)
+        || (frame.valueRange.size() <= 0)
+        )
+    {
+        return frame;
+    }
+
+    QReadLocker locker(frame.pDataLock);
+
+    if (frame.bDensity)
+    {
+        renderDensityTiles(&frame);
+    }
+    else
+    {
+        renderLineTiles(&frame);
+    }
+
+    locker.unlock();
+
+    /* Composite visible tiles */
+    QPainter painter(&frame.image);
+    const double frameLeft = frame.keyRange.lower * frame.tileScale;
+
+    foreach(const Tile &tile, frame.tiles)
+    {
+        const double x = tile.index * static_cast<double>(cTileWidth) - frameLeft;
+
+        if (
+            (x < frame.size.width())
+            && (x + cTileWidth > 0)
+            )
+        {
+            painter.drawImage(QPointF(x, 0), tile.image);
+        }
+    }
+
+    return frame;
+}
+
+/*!
+ * Render missing graph images of all tiles and composite them (data lock is held)
+ */
+void GraphRasterizer::renderLineTiles(Frame * pFrame)
+{
+    Frame &frame = *pFrame;
+
+    const QSize tileSize(cTileWidth, frame.size.height());
+    const Frame &renderFrame = frame;
+
+    /* Several tiles per batch when there are less graphs than threads */
+    const qint32 threadCount = qMax(QThread::idealThreadCount(), 1);
+    const qint32 tilesPerBatch = qMax(1, threadCount / qMax(frame.graphs.size(), 1));
+
+    qint64 graphImageBytes = 0;
+
+    for (qint32 batchStart = 0; batchStart < frame.tiles.size(); batchStart += tilesPerBatch)
+    {
+        const qint32 batchEnd = qMin(batchStart + tilesPerBatch, frame.tiles.size());
+
+        /* Collect graph images that still need to be rendered (lists are detached here, before threads write to them) */
+        QList<QPair<Tile *, qint32> > workList;
+        for (qint32 tileIdx = batchStart; tileIdx < batchEnd; tileIdx++)
+        {
+            Tile &tile = frame.tiles[tileIdx];
+
+            if (tile.image.isNull())
+            {
+                while (tile.graphImages.size() < frame.graphs.size())
+                {
+                    tile.graphImages.append(QImage());
+                }
+
+                for (qint32 graphIdx = 0; graphIdx < frame.graphs.size(); graphIdx++)
+                {
+                    if (tile.graphImages[graphIdx].isNull())
+                    {
+                        workList.append(qMakePair(&tile, graphIdx));
+                    }
+                }
+            }
+        }
+
+        QtConcurrent::blockingMap(workList, [&renderFrame, &tileSize](const QPair<Tile *, qint32> &work)
+        {
+            QImage image = createImage(tileSize, renderFrame.pixelRatio);
+            renderGraph(&image, renderFrame, renderFrame.graphs.at(work.second), work.first->index);
+
+            work.first->graphImages[work.second] = image;
+        });
+
+        /* Composite graphs in draw order */
+        for (qint32 tileIdx = batchStart; tileIdx < batchEnd; tileIdx++)
+        {
+            Tile &tile = frame.tiles[tileIdx];
+
+            if (tile.image.isNull())
+            {
+                tile.image = createImage(tileSize, frame.pixelRatio);
+
+                QPainter painter(&tile.image);
+                foreach(const QImage &graphImage, tile.graphImages)
+                {
+                    painter.drawImage(0, 0, graphImage);
+                }
+            }
+
+            /* Graph images are only kept for the cache as long as they fit in the budget */
+            for (qint32 graphIdx = 0; graphIdx < tile.graphImages.size(); graphIdx++)
+            {
+                const qint64 bytes = tile.graphImages[graphIdx].byteCount();
+
+                if (graphImageBytes + bytes <= _cGraphImageBytes)
+                {
+                    graphImageBytes += bytes;
+                }
+                else
+                {
+                    tile.graphImages[graphIdx] = QImage();
+                }
+            }
+        }
+    }
+}
+
+/*!
+ * Render missing tiles as colour-mapped density of all graphs (data lock is held)
+ *
+ * Every work item accumulates the hit counts of a range of graphs for one tile,
+ * the counts of all ranges are summed before colour mapping.
+ */
+void GraphRasterizer::renderDensityTiles(Frame * pFrame)
+{
+    Frame &frame = *pFrame;
+
+    const QSize tileSize(cTileWidth, frame.size.height());
+    const QSize pixelSize = tileSize * frame.pixelRatio;
+    const qint32 pixelCount = pixelSize.width() * pixelSize.height();
+    const Frame &renderFrame = frame;
+
+    /* One count buffer per thread */
+    const qint32 threadCount = qMax(QThread::idealThreadCount(), 1);
+    const qint32 chunksPerTile = qBound(1, frame.graphs.size(), threadCount);
+    const qint32 tilesPerBatch = qMax(1, threadCount / chunksPerTile);
+
+    const QVector<QRgb> &colorMap = densityColorMap();
+    const double logSaturation = qLn(1 + _cDensitySaturation);
+
+    for (qint32 batchStart = 0; batchStart < frame.tiles.size(); batchStart += tilesPerBatch)
+    {
+        const qint32 batchEnd = qMin(batchStart + tilesPerBatch, frame.tiles.size());
+
+        QList<DensityWork> workList;
+        for (qint32 tileIdx = batchStart; tileIdx < batchEnd; tileIdx++)
+        {
+            Tile &tile = frame.tiles[tileIdx];
+
+            if (tile.image.isNull())
+            {
+                for (qint32 chunk = 0; chunk < chunksPerTile; chunk++)
+                {
+                    DensityWork work;
+                    work.pTile = &tile;
+                    work.firstGraph = chunk * frame.graphs.size() / chunksPerTile;
+                    work.endGraph = (chunk + 1) * frame.graphs.size() / chunksPerTile;
+
+                    workList.append(work);
+                }
+            }
+        }
+
+        QtConcurrent::blockingMap(workList, [&renderFrame, &pixelSize, pixelCount](DensityWork &work)
+        {
+            work.counts.fill(0, pixelCount);
+
+            for (qint32 graphIdx = work.firstGraph; graphIdx < work.endGraph; graphIdx++)
+            {
+                accumulateDensity(work.counts.data(), pixelSize, renderFrame, renderFrame.graphs.at(graphIdx), work.pTile->index);
+            }
+        });
+
+        /* Sum counts of all chunks of a tile (work items of a tile are consecutive) */
+        qint32 workIdx = 0;
+        while (workIdx < workList.size())
+        {
+            Tile * pTile = workList[workIdx].pTile;
+            float * pCounts = workList[workIdx].counts.data();
+
+            for (workIdx++; (workIdx < workList.size()) && (workList[workIdx].pTile == pTile); workIdx++)
+            {
+                const float * pChunkCounts = workList[workIdx].counts.constData();
+                for (qint32 idx = 0; idx < pixelCount; idx++)
+                {
+                    pCounts[idx] += pChunkCounts[idx];
+                }
+            }
+
+            /* Logarithmic colour map with fixed saturation, so neighbouring tiles match */
+            pTile->image = createImage(tileSize, frame.pixelRatio);
+            for (qint32 row = 0; row < pixelSize.height(); row++)
+            {
+                QRgb * pLine = reinterpret_cast<QRgb *>(pTile->image.scanLine(row));
+                const float * pRowCounts = pCounts + row * pixelSize.width();
+
+                for (qint32 column = 0; column < pixelSize.width(); column++)
+                {
+                    if (pRowCounts[column] > 0)
+                    {
+                        const double level = qMin(qLn(1 + pRowCounts[column]) / logSaturation, 1.0);
+                        pLine[column] = colorMap[1 + qRound(level * (colorMap.size() - 2))];
+                    }
+                }
+            }
+        }
+    }
+}
+
+/*!
+ * Check whether rendering \a frame and \a other results in the same image (decimation is ignored)
+ */
+bool GraphRasterizer::isEqual(const Frame &frame, const Frame &other)
+{
+    if (
+        (frame.size != other.size)
+        || (frame.pixelRatio != other.pixelRatio)
+        || (frame.keyRange != other.keyRange)
+        || (frame.valueRange != other.valueRange)
+        || (frame.bAntialiased != other.bAntialiased)
+        || (frame.bDensity != other.bDensity)
+        || (frame.graphs.size() != other.graphs.size())
+        )
+    {
+        return false;
+    }
+
+    for (qint32 idx = 0; idx < frame.graphs.size(); idx++)
+    {
+        if (!isSameGraph(frame.graphs[idx], other.graphs[idx]))
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+bool GraphRasterizer::isSameGraph(const GraphLayer &layer, const GraphLayer &other)
+{
+    return (layer.pDataMap == other.pDataMap)
+            && (layer.dataSize == other.dataSize)
+            && (layer.dataRevision == other.dataRevision)
+            && (layer.pen == other.pen)
+            && (layer.gain == other.gain)
+            && (layer.offset == other.offset)
+            && (layer.scatterSize == other.scatterSize);
+}
+
+/*!
+ * Number of points that need to be processed to render the missing tiles of \a frame
+ */
+qint64 GraphRasterizer::pointCount(const Frame &frame)
+{
+    qint64 count = 0;
+
+    if (frame.tileScale <= 0)
+    {
+        return count;
+    }
+
+    QReadLocker locker(frame.pDataLock);
+
+    foreach(const Tile &tile, frame.tiles)
+    {
+        if (!tile.image.isNull())
+        {
+            continue;
+        }
+
+        const double keyLower = tileKey(tile.index, frame.tileScale);
+        const double keyUpper = tileKey(tile.index + 1, frame.tileScale);
+
+        for (qint32 graphIdx = 0; graphIdx < frame.graphs.size(); graphIdx++)
+        {
+            if (
+                (graphIdx < tile.graphImages.size())
+                && !tile.graphImages[graphIdx].isNull()
+                )
+            {
+                continue;
+            }
+
+            const QSharedPointer<QCPGraphDataContainer> &pDataMap = frame.graphs[graphIdx].pDataMap;
+            count += pDataMap->findEnd(keyUpper, true) - pDataMap->findBegin(keyLower, true);
+        }
+    }
+
+    return count;
+}
+
+/*!
+ * First and last tile that are (partially) visible in \a frame
+ */
+void GraphRasterizer::tileRange(const Frame &frame, qint64 * pFirst, qint64 * pLast)
+{
+    *pFirst = tileIndex(frame.keyRange.lower, frame.tileScale);
+    *pLast = tileIndex(frame.keyRange.upper, frame.tileScale);
+}
+
+/*!
+ * Index of tile that contains \a key
+ */
+qint64 GraphRasterizer::tileIndex(double key, double tileScale)
+{
+    return static_cast<qint64>(std::floor(key * tileScale / cTileWidth));
+}
+
+/*!
+ * Key at left border of tile \a index
+ */
+double GraphRasterizer::tileKey(qint64 index, double tileScale)
+{
+    return index * static_cast<double>(cTileWidth) / tileScale;
+}
+
+QImage GraphRasterizer::createImage(const QSize &size, double pixelRatio)
+{
+    QImage image(size * pixelRatio, QImage::Format_ARGB32_Premultiplied);
+
+    if (!image.isNull())
+    {
+        image.setDevicePixelRatio(pixelRatio);
+        image.fill(Qt::transparent);
+    }
+
+    return image;
+}
+
+/*!
+ * Render one scatter point (circle with diameter \a size) that is blitted for every sample
+ */
+QImage GraphRasterizer::createScatterSprite(const QPen &pen, double size, double pixelRatio, bool bAntialiased)
+{
+    /* Odd size in device pixels, so the circle is centered on a pixel */
+    qint32 side = qCeil((size + qMax(pen.widthF(), 1.0) + 2) * pixelRatio);
+    if ((side % 2) == 0)
+    {
+        side++;
+    }
+
+    QImage sprite(side, side, QImage::Format_ARGB32_Premultiplied);
+    sprite.setDevicePixelRatio(pixelRatio);
+    sprite.fill(Qt::transparent);
+
+    const double center = side / pixelRatio / 2;
+    const double radius = size / 2;
+
+    QPainter painter(&sprite);
+    painter.setRenderHint(QPainter::Antialiasing, bAntialiased);
+    painter.setPen(pen);
+    painter.setBrush(Qt::NoBrush);
+    painter.drawEllipse(QPointF(center, center), radius, radius);
+
+    return sprite;
+}
+
+void GraphRasterizer::renderGraph(QImage * pImage, const Frame &frame, const GraphLayer &graph, qint64 tileIdx)
+{
+    const double width = cTileWidth;
+    const double height = frame.size.height();
+
+    const double keyLower = tileKey(tileIdx, frame.tileScale);
+    const double keyUpper = tileKey(tileIdx + 1, frame.tileScale);
+
+    const double keyScale = frame.tileScale;
+    /* Pixel row is valueOrigin - sample * valueScale, includes gain and offset of graph */
+    const double valueScale = graph.gain * height / frame.valueRange.size();
+    const double valueOrigin = height - 1 - (graph.offset - frame.valueRange.lower) * height / frame.valueRange.size();
+
+    /* Include one point outside of the tile on both sides, so lines continue to the border */
+    QCPGraphDataContainer::const_iterator it = graph.pDataMap->findBegin(keyLower, true);
+    const QCPGraphDataContainer::const_iterator endIt = graph.pDataMap->findEnd(keyUpper, true);
+
+    /* Thin solid lines without antialiasing are written directly in the image */
+    const bool bFastLine = !frame.bAntialiased
+                            && (graph.pen.style() == Qt::SolidLine)
+                            && (graph.pen.brush().style() == Qt::SolidPattern)
+                            && (graph.pen.widthF() <= 1)
+                            && (pImage->format() == QImage::Format_ARGB32_Premultiplied);
+    const QRgb color = qPremultiply(graph.pen.color().rgba());
+
+    QPainter painter;
+    if (!bFastLine)
+    {
+        painter.begin(pImage);
+        painter.setRenderHint(QPainter::Antialiasing, frame.bAntialiased);
+        painter.setPen(graph.pen);
+        painter.setBrush(Qt::NoBrush);
+    }
+
+    /* Coarse frame only draws every nth point */
+    const qint32 step = qMax(frame.decimation, 1);
+
+    QVector<QPointF> line;
+
+    auto flush = [&]()
+    {
+        if (bFastLine)
+        {
+            rasterizeLine(pImage, color, frame.pixelRatio, &line);
+        }
+        else
+        {
+            flushLine(&painter, &line);
+        }
+    };
+
+    if ((endIt - it) / step > (_cPointsPerColumnThreshold * width))
+    {
+        /* Reduce every pixel column to first, min, max and last point */
+        line.reserve(4 * cTileWidth + 8);
+
+        bool bColumnValid = false;
+        qint64 column = 0;
+        double first = 0;
+        double min = 0;
+        double max = 0;
+        double last = 0;
+
+        for (; it != endIt; it += qMin(step, static_cast<qint32>(endIt - it)))
+        {
+            if (qIsNaN(it->value))
+            {
+                if (bColumnValid)
+                {
+                    appendColumn(&line, column, first, min, max, last);
+                    bColumnValid = false;
+                }
+
+                flush();
+                continue;
+            }
+
+            const double x = qBound(-_cCoordinateLimit, (it->key - keyLower) * keyScale, _cCoordinateLimit);
+            const double y = qBound(-_cCoordinateLimit, valueOrigin - it->value * valueScale, _cCoordinateLimit);
+            const qint64 pointColumn = static_cast<qint64>(qFloor(x));
+
+            if (bColumnValid && (pointColumn == column))
+            {
+                min = qMin(min, y);
+                max = qMax(max, y);
+                last = y;
+            }
+            else
+            {
+                if (bColumnValid)
+                {
+                    appendColumn(&line, column, first, min, max, last);
+                }
+
+                column = pointColumn;
+                first = y;
+                min = y;
+                max = y;
+                last = y;
+                bColumnValid = true;
+            }
+        }
+
+        if (bColumnValid)
+        {
+            appendColumn(&line, column, first, min, max, last);
+        }
+
+        flush();
+    }
+    else
+    {
+        QVector<QPointF> scatterPoints;
+
+        for (; it != endIt; it += qMin(step, static_cast<qint32>(endIt - it)))
+        {
+            if (qIsNaN(it->value))
+            {
+                flush();
+                continue;
+            }
+
+            const double x = qBound(-_cCoordinateLimit, (it->key - keyLower) * keyScale, _cCoordinateLimit);
+            const double y = qBound(-_cCoordinateLimit, valueOrigin - it->value * valueScale, _cCoordinateLimit);
+
+            line.append(QPointF(x, y));
+
+            if (graph.scatterSize > 0)
+            {
+                scatterPoints.append(QPointF(x, y));
+            }
+        }
+
+        flush();
+
+        if (!scatterPoints.isEmpty())
+        {
+            /* Scatter points are drawn on top of the lines */
+            if (!painter.isActive())
+            {
+                painter.begin(pImage);
+                painter.setRenderHint(QPainter::Antialiasing, frame.bAntialiased);
+                painter.setPen(graph.pen);
+                painter.setBrush(Qt::NoBrush);
+            }
+
+            if (graph.scatterSprite.isNull())
+            {
+                const double radius = graph.scatterSize / 2;
+                foreach(const QPointF &point, scatterPoints)
+                {
+                    painter.drawEllipse(point, radius, radius);
+                }
+            }
+            else
+            {
+                /* Blit pre-rendered point, centered on whole device pixel to avoid smoothing */
+                const QPointF center(graph.scatterSprite.width() / frame.pixelRatio / 2, graph.scatterSprite.height() / frame.pixelRatio / 2);
+                foreach(const QPointF &point, scatterPoints)
+                {
+                    const QPointF pixel(qRound(point.x() * frame.pixelRatio) / frame.pixelRatio, qRound(point.y() * frame.pixelRatio) / frame.pixelRatio);
+                    painter.drawImage(pixel - center, graph.scatterSprite);
+                }
+            }
+        }
+    }
+}
+
+void GraphRasterizer::appendColumn(QVector<QPointF> * pLine, double x, double first, double min, double max, double last)
+{
+    pLine->append(QPointF(x, first));
+
+    if (min != max)
+    {
+        pLine->append(QPointF(x, min));
+        pLine->append(QPointF(x, max));
+    }
+
+    if (last != first)
+    {
+        pLine->append(QPointF(x, last));
+    }
+}
+
+void GraphRasterizer::flushLine(QPainter * pPainter, QVector<QPointF> * pLine)
+{
+    if (pLine->size() > 1)
+    {
+        pPainter->drawPolyline(pLine->constData(), pLine->size());
+    }
+    else if (pLine->size() == 1)
+    {
+        pPainter->drawPoint(pLine->first());
+    }
+
+    pLine->clear();
+}
+
+/*!
+ * Draw \a pLine as 1 pixel wide line directly in \a pImage (premultiplied ARGB) and clear it
+ */
+void GraphRasterizer::rasterizeLine(QImage * pImage, QRgb color, double pixelRatio, QVector<QPointF> * pLine)
+{
+    const qint32 pixelsPerLine = pImage->bytesPerLine() / static_cast<qint32>(sizeof(QRgb));
+    QRgb * pBits = reinterpret_cast<QRgb *>(pImage->bits());
+
+    rasterizeSegments(pLine->constData(), pLine->size(), pixelRatio, pImage->size(), [=](qint32 column, qint32 firstRow, qint32 lastRow)
+    {
+        QRgb * pPixel = pBits + firstRow * pixelsPerLine + column;
+        for (qint32 row = firstRow; row <= lastRow; row++)
+        {
+            *pPixel = color;
+            pPixel += pixelsPerLine;
+        }
+    });
+
+    pLine->clear();
+}
+
+/*!
+ * Add hit count of every pixel that \a graph passes in tile \a tileIdx to \a pCounts
+ */
+void GraphRasterizer::accumulateDensity(float * pCounts, const QSize &pixelSize, const Frame &frame, const GraphLayer &graph, qint64 tileIdx)
+{
+    const double height = frame.size.height();
+
+    const double keyLower = tileKey(tileIdx, frame.tileScale);
+    const double keyUpper = tileKey(tileIdx + 1, frame.tileScale);
+
+    const double keyScale = frame.tileScale;
+    /* Pixel row is valueOrigin - sample * valueScale, includes gain and offset of graph */
+    const double valueScale = graph.gain * height / frame.valueRange.size();
+    const double valueOrigin = height - 1 - (graph.offset - frame.valueRange.lower) * height / frame.valueRange.size();
+
+    const qint32 step = qMax(frame.decimation, 1);
+    const qint32 pixelWidth = pixelSize.width();
+
+    auto addSpan = [pCounts, pixelWidth](qint32 column, qint32 firstRow, qint32 lastRow)
+    {
+        float * pCount = pCounts + firstRow * pixelWidth + column;
+        for (qint32 row = firstRow; row <= lastRow; row++)
+        {
+            *pCount += 1;
+            pCount += pixelWidth;
+        }
+    };
+
+    QCPGraphDataContainer::const_iterator it = graph.pDataMap->findBegin(keyLower, true);
+    const QCPGraphDataContainer::const_iterator endIt = graph.pDataMap->findEnd(keyUpper, true);
+
+    QPointF segment[2];
+    bool bPreviousValid = false;
+
+    for (; it != endIt; it += qMin(step, static_cast<qint32>(endIt - it)))
+    {
+        if (qIsNaN(it->value))
+        {
+            bPreviousValid = false;
+            continue;
+        }
+
+        segment[0] = segment[1];
+        segment[1] = QPointF(qBound(-_cCoordinateLimit, (it->key - keyLower) * keyScale, _cCoordinateLimit),
+                             qBound(-_cCoordinateLimit, valueOrigin - it->value * valueScale, _cCoordinateLimit));
+
+        if (bPreviousValid)
+        {
+            rasterizeSegments(segment, 2, frame.pixelRatio, pixelSize, addSpan);
+        }
+        else
+        {
+            rasterizeSegments(&segment[1], 1, frame.pixelRatio, pixelSize, addSpan);
+        }
+
+        bPreviousValid = true;
+    }
+}
+
+/*!
+ * Colours for density levels, entry 0 is transparent (premultiplied ARGB)
+ */
+const QVector<QRgb> &GraphRasterizer::densityColorMap()
+{
+    static const QVector<QRgb> colorMap = []()
+    {
+        const QList<QPair<double, QColor> > stops = QList<QPair<double, QColor> >()
+                << qMakePair(0.0, QColor(30, 30, 160))
+                << qMakePair(0.35, QColor(0, 160, 255))
+                << qMakePair(0.65, QColor(255, 220, 0))
+                << qMakePair(1.0, QColor(255, 40, 0));
+
+        QVector<QRgb> map;
+        map.append(qPremultiply(qRgba(0, 0, 0, 0)));
+
+        for (qint32 idx = 0; idx < _cDensityColorCount; idx++)
+        {
+            const double level = static_cast<double>(idx) / (_cDensityColorCount - 1);
+
+            qint32 stopIdx = 1;
+            while ((stopIdx < stops.size() - 1) && (stops[stopIdx].first < level))
+            {
+                stopIdx++;
+            }
+
+            const QColor &from = stops[stopIdx - 1].second;
+            const QColor &to = stops[stopIdx].second;
+            const double fraction = (level - stops[stopIdx - 1].first) / (stops[stopIdx].first - stops[stopIdx - 1].first);
+
+            map.append(qRgb(qRound(from.red() + (to.red() - from.red()) * fraction),
+                            qRound(from.green() + (to.green() - from.green()) * fraction),
+                            qRound(from.blue() + (to.blue() - from.blue()) * fraction)));
+        }
+
+        return map;
+    }();
+
+    return colorMap;
+}
@@ -0,0 +1,127 @@
+#ifndef GRAPHRASTERIZER_H
+#define GRAPHRASTERIZER_H
+
+#include <QImage>
+#include <QPen>
+#include <QReadWriteLock>
+#include "qcustomplot.h"
+
+/* Forward declaration */
+class GraphDataIndex;
+
+/*
+ * Rasterizes graph lines into an image, independent of the plot widget
+ *
+ * A frame only contains copies of the plot state (axis ranges, size, pens) and
+ * shared pointers to the data containers, so it can be rendered on a worker thread.
+ * The data lock is held for reading while the containers are accessed.
+ *
+ * Gain and offset of a graph are folded into the mapping from value to pixel,
+ * so the samples are never copied or modified.
+ *
+ * When there are more points than pixel columns, every column is reduced to
+ * its first, minimum, maximum and last value before drawing.
+ * Thin solid lines without antialiasing bypass QPainter and are written directly in the image.
+ *
+ * The key axis is split in tiles of cTileWidth pixels at the zoom level of the frame (tileScale).
+ * Tiles are aligned on multiples of the tile width, so they stay valid while panning.
+ * Every tile is composited from one image per graph. Graph tiles are rendered in parallel.
+ * Tiles that are already present in the frame (see TileCache) aren't rendered again.
+ *
+ * In density mode, the hit count of all graphs per pixel is accumulated (in parallel per
+ * range of graphs) and colour-mapped, instead of drawing separate lines.
+ *
+ * A coarse frame (decimation > 1) only draws every nth point, it is used as a quick
+ * preview when rendering the full frame would exceed the frame budget.
+ * */
+class GraphRasterizer
+{
+
+public:
+
+    typedef struct
+    {
+        QSharedPointer<QCPGraphDataContainer> pDataMap;
+        qint32 dataSize; // size when frame was created, detects appended data
+        quint32 dataRevision; // changes when existing points are modified
+        QSharedPointer<GraphDataIndex> pDataIndex; // tells which points are modified since a revision, can be null
+        QPen pen;
+        double gain; // drawn value is gain * sample + offset
+        double offset;
+        double scatterSize; // 0 when no scatter points are drawn
+        QImage scatterSprite; // pre-rendered scatter point, see createScatterSprite
+
+    } GraphLayer;
+
+    typedef struct
+    {
+        qint64 index; // position is index * cTileWidth pixels at tileScale
+        QImage image; // composition of graphImages, null when it still needs to be composited
+        QList<QImage> graphImages; // one per graph, null when it still needs to be rendered
+
+    } Tile;
+
+    typedef struct
+    {
+        QSize size; // axis rect size
+        double pixelRatio;
+        QCPRange keyRange;
+        QCPRange valueRange;
+        bool bAntialiased;
+        bool bDensity; // hit count of all graphs per pixel instead of lines
+        QList<GraphLayer> graphs; // in draw order
+        QReadWriteLock * pDataLock;
+
+        double tileScale; // pixels per key unit
+        QList<Tile> tiles; // visible and prefetched tiles
+        QImage image; // composition of visible tiles
+
+        qint32 decimation; // only every nth point is drawn, 1 for full fidelity
+
+    } Frame;
+
+    static Frame render(Frame frame);
+    static bool isEqual(const Frame &frame, const Frame &other);
+    static bool isSameGraph(const GraphLayer &layer, const GraphLayer &other);
+    static qint64 pointCount(const Frame &frame);
+
+    static void tileRange(const Frame &frame, qint64 * pFirst, qint64 * pLast);
+    static qint64 tileIndex(double key, double tileScale);
+    static double tileKey(qint64 index, double tileScale);
+    static QImage createImage(const QSize &size, double pixelRatio);
+    static QImage createScatterSprite(const QPen &pen, double size, double pixelRatio, bool bAntialiased);
+
+    static const qint32 cTileWidth = 256;
+
+private:
+
+    typedef struct
+    {
+        Tile * pTile;
+        qint32 firstGraph;
+        qint32 endGraph;
+        QVector<float> counts; // hit count per device pixel
+
+    } DensityWork;
+
+    static void renderLineTiles(Frame * pFrame);
+    static void renderDensityTiles(Frame * pFrame);
+    static void renderGraph(QImage * pImage, const Frame &frame, const GraphLayer &graph, qint64 tileIdx);
+    static void accumulateDensity(float * pCounts, const QSize &pixelSize, const Frame &frame, const GraphLayer &graph, qint64 tileIdx);
+    static const QVector<QRgb> &densityColorMap();
+    static void appendColumn(QVector<QPointF> * pLine, double x, double first, double min, double max, double last);
+    static void flushLine(QPainter * pPainter, QVector<QPointF> * pLine);
+    static void rasterizeLine(QImage * pImage, QRgb color, double pixelRatio, QVector<QPointF> * pLine);
+
+    template <typename SpanFunction>
+    static void rasterizeSegments(const QPointF * pPoints, qint32 count, double pixelRatio, const QSize &pixelSize, SpanFunction fillSpan);
+
+    static const qint32 _cPointsPerColumnThreshold = 2;
+    static const double _cCoordinateLimit;
+    static const qint64 _cGraphImageBytes = 128 * 1024 * 1024;
+    static const qint32 _cDensitySaturation = 1000; // hit count with brightest colour
+    static const qint32 _cDensityColorCount = 256;
+
+};
+
+#endif // GRAPHRASTERIZER_H
@@ -0,0 +1,184 @@
+#include "graphdataindex.h"
+
+#include "myqcpgraph.h"
+
+MyQCPGraph::MyQCPGraph(QCPAxis *keyAxis, QCPAxis *valueAxis):
+    QCPGraph(keyAxis, valueAxis)
+{
+    _bExternalRendering = false;
+    _placeholderValue = 0;
+    _gain = 1;
+    _offset = 0;
+}
+
+/*!
+  Set index of the data container of this graph, used to speed up range queries
+*/
+void MyQCPGraph::setDataIndex(QSharedPointer<GraphDataIndex> pDataIndex)
+{
+    _pDataIndex = pDataIndex;
+}
+
+/*!
+  When enabled, the graph doesn't draw itself, but is drawn by AsyncGraphRenderer
+*/
+void MyQCPGraph::setExternalRendering(bool bExternal)
+{
+    _bExternalRendering = bExternal;
+}
+
+bool MyQCPGraph::externalRendering() const
+{
+    return _bExternalRendering;
+}
+
+/*!
+  Drawn value is \a gain * sample + \a offset, the samples aren't modified
+*/
+void MyQCPGraph::setScaling(double gain, double offset)
+{
+    _gain = gain;
+    _offset = offset;
+}
+
+double MyQCPGraph::gain() const
+{
+    return _gain;
+}
+
+double MyQCPGraph::offset() const
+{
+    return _offset;
+}
+
+double MyQCPGraph::scaledValue(double sample) const
+{
+    return _gain * sample + _offset;
+}
+
+/*!
+  Show \a value over \a keyRange while the graph has no samples
+*/
+void MyQCPGraph::setPlaceholder(double value, const QCPRange &keyRange)
+{
+    /* Renderer could still use the previous points, so create new container */
+    _pPlaceholderMap = QSharedPointer<QCPGraphDataContainer>(new QCPGraphDataContainer());
+    _pPlaceholderMap->add(QCPGraphData(keyRange.lower, value));
+    _pPlaceholderMap->add(QCPGraphData(keyRange.upper, value));
+
+    _placeholderValue = value;
+}
+
+void MyQCPGraph::clearPlaceholder()
+{
+    _pPlaceholderMap.clear();
+}
+
+/*!
+  Placeholder is only shown until samples are added
+*/
+bool MyQCPGraph::isPlaceholder() const
+{
+    return !_pPlaceholderMap.isNull() && mDataContainer->isEmpty();
+}
+
+double MyQCPGraph::placeholderValue() const
+{
+    return _placeholderValue;
+}
+
+QCPRange MyQCPGraph::placeholderKeyRange() const
+{
+    if (_pPlaceholderMap.isNull())
+    {
+        return QCPRange();
+    }
+
+    return QCPRange(_pPlaceholderMap->constBegin()->key, (_pPlaceholderMap->constEnd() - 1)->key);
+}
+
+/*!
+  Data that should be drawn: the samples of the graph, or the placeholder segment
+*/
+QSharedPointer<QCPGraphDataContainer> MyQCPGraph::renderData() const
+{
+    return isPlaceholder() ? _pPlaceholderMap : mDataContainer;
+}
+
+/*!
+  Changes when existing samples are modified, stays the same when samples are appended
+*/
+quint32 MyQCPGraph::dataRevision() const
+{
+    return _pDataIndex.isNull() ? 0 : _pDataIndex->revision();
+}
+
+QSharedPointer<GraphDataIndex> MyQCPGraph::dataIndex() const
+{
+    return _pDataIndex;
+}
+
+QCPRange MyQCPGraph::getKeyRange(bool &foundRange, QCP::SignDomain inSignDomain) const
+{
+    if (isPlaceholder())
+    {
+        return _pPlaceholderMap->keyRange(foundRange, inSignDomain);
+    }
+
+    if (
+        _pDataIndex.isNull()
+        || (inSignDomain != QCP::sdBoth)
+        )
+    {
+        return QCPGraph::getKeyRange(foundRange, inSignDomain);
+    }
+
+    return _pDataIndex->keyBounds(foundRange);
+}
+
+QCPRange MyQCPGraph::getValueRange(bool &foundRange, QCP::SignDomain inSignDomain, const QCPRange &inKeyRange) const
+{
+    QCPRange range = sampleValueRange(foundRange, inSignDomain, inKeyRange);
+
+    /* Apply gain and offset, negative gain swaps bounds */
+    range = QCPRange(_gain * range.lower + _offset, _gain * range.upper + _offset);
+    range.normalize();
+
+    return range;
+}
+
+/*!
+  Value range of the samples, without gain and offset
+*/
+QCPRange MyQCPGraph::sampleValueRange(bool &foundRange, QCP::SignDomain inSignDomain, const QCPRange &inKeyRange) const
+{
+    if (isPlaceholder())
+    {
+        return _pPlaceholderMap->valueRange(foundRange, inSignDomain, inKeyRange);
+    }
+
+    if (
+        _pDataIndex.isNull()
+        || (inSignDomain != QCP::sdBoth)
+        )
+    {
+        return QCPGraph::getValueRange(foundRange, inSignDomain, inKeyRange);
+    }
+
+    if (inKeyRange != QCPRange())
+    {
+        return _pDataIndex->valueRange(foundRange, inKeyRange);
+    }
+    else
+    {
+        return _pDataIndex->valueBounds(foundRange);
+    }
+}
+
+void MyQCPGraph::draw(QCPPainter *painter)
+{
+    if (!_bExternalRendering)
+    {
+        QCPGraph::draw(painter);
+    }
+}
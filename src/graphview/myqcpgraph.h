@@ -0,0 +1,64 @@
+#ifndef MYQCPGRAPH_H
+#define MYQCPGRAPH_H
+
+#include "qcustomplot.h"
+
+/* forward declaration */
+class GraphDataIndex;
+
+/*
+ * Graph with a data index for fast range queries
+ *
+ * A placeholder graph has no samples of its own. It represents a constant value
+ * over the time axis of the other graphs and is drawn as a single line segment,
+ * so a cleared or missing channel doesn't need a sample per key.
+ *
+ * Gain and offset are applied when the graph is drawn and when its range is requested,
+ * the samples in the data container are kept unmodified.
+ * */
+class MyQCPGraph : public QCPGraph
+{
+public:
+    MyQCPGraph(QCPAxis *keyAxis, QCPAxis *valueAxis);
+
+    void setDataIndex(QSharedPointer<GraphDataIndex> pDataIndex);
+
+    void setExternalRendering(bool bExternal);
+    bool externalRendering() const;
+
+    void setScaling(double gain, double offset);
+    double gain() const;
+    double offset() const;
+    double scaledValue(double sample) const;
+
+    void setPlaceholder(double value, const QCPRange &keyRange);
+    void clearPlaceholder();
+    bool isPlaceholder() const;
+    double placeholderValue() const;
+    QCPRange placeholderKeyRange() const;
+
+    QSharedPointer<QCPGraphDataContainer> renderData() const;
+    quint32 dataRevision() const;
+    QSharedPointer<GraphDataIndex> dataIndex() const;
+
+    virtual QCPRange getKeyRange(bool &foundRange, QCP::SignDomain inSignDomain = QCP::sdBoth) const;
+    virtual QCPRange getValueRange(bool &foundRange, QCP::SignDomain inSignDomain = QCP::sdBoth, const QCPRange &inKeyRange = QCPRange()) const;
+
+protected:
+    virtual void draw(QCPPainter *painter);
+
+private:
+    QCPRange sampleValueRange(bool &foundRange, QCP::SignDomain inSignDomain, const QCPRange &inKeyRange) const;
+
+    QSharedPointer<GraphDataIndex> _pDataIndex;
+    bool _bExternalRendering;
+
+    double _gain;
+    double _offset;
+
+    double _placeholderValue; // sample value, gain and offset are applied
+    QSharedPointer<QCPGraphDataContainer> _pPlaceholderMap; // begin and end point of placeholder, null when no placeholder
+
+};
+
+#endif // MYQCPGRAPH_H
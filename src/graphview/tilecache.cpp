@@ -0,0 +1,338 @@
+#include <QSet>
+
+#include <algorithm> // std::sort
+#include <limits>
+
+#include "graphdataindex.h"
+#include "tilecache.h"
+
+/* Dragging and sliding change the size of the key range by rounding errors only, keep zoom level */
+const double TileCache::_cScaleTolerance = 1e-6;
+
+TileCache::TileCache()
+{
+    _bValid = false;
+    _tileScale = 0;
+    _height = 0;
+    _pixelRatio = 1;
+    _bAntialiased = false;
+    _bDensity = false;
+}
+
+/*!
+ * Zoom level (pixels per key unit) to use for tiles of \a frame
+ * Drops all tiles when they can't be used for this frame
+ */
+double TileCache::tileScale(const GraphRasterizer::Frame &frame)
+{
+    if (
+        (frame.keyRange.size() <= 0)
+        || (frame.size.width() <= 0)
+        )
+    {
+        return 0;
+    }
+
+    const double scale = frame.size.width() / frame.keyRange.size();
+
+    if (
+        !_bValid
+        || (qAbs(scale - _tileScale) > _cScaleTolerance * _tileScale)
+        || (frame.valueRange != _valueRange)
+        || (frame.size.height() != _height)
+        || (frame.pixelRatio != _pixelRatio)
+        || (frame.bAntialiased != _bAntialiased)
+        || (frame.bDensity != _bDensity)
+        )
+    {
+        clear();
+
+        _bValid = true;
+        _tileScale = scale;
+        _valueRange = frame.valueRange;
+        _height = frame.size.height();
+        _pixelRatio = frame.pixelRatio;
+        _bAntialiased = frame.bAntialiased;
+        _bDensity = frame.bDensity;
+    }
+
+    return _tileScale;
+}
+
+/*!
+ * Tile with all images that are cached, missing images are null
+ */
+GraphRasterizer::Tile TileCache::tile(const QList<GraphRasterizer::GraphLayer> &graphs, qint64 index) const
+{
+    GraphRasterizer::Tile tile;
+    tile.index = index;
+
+    if (index < firstChangedTile(_compositeGraphs, graphs))
+    {
+        tile.image = _compositeTiles.value(index);
+    }
+
+    if (tile.image.isNull())
+    {
+        foreach(const GraphRasterizer::GraphLayer &graph, graphs)
+        {
+            QImage image;
+
+            QHash<const QCPGraphDataContainer *, GraphTiles>::const_iterator it = _graphTiles.constFind(graph.pDataMap.data());
+            if (
+                (it != _graphTiles.constEnd())
+                && (index < firstChangedTile(it->graph, graph))
+                )
+            {
+                image = it->tiles.value(index);
+            }
+
+            tile.graphImages.append(image);
+        }
+    }
+
+    return tile;
+}
+
+bool TileCache::contains(const QList<GraphRasterizer::GraphLayer> &graphs, qint64 index) const
+{
+    return (index < firstChangedTile(_compositeGraphs, graphs)) && _compositeTiles.contains(index);
+}
+
+/*!
+ * Store all rendered tiles of \a frame
+ */
+void TileCache::insert(const GraphRasterizer::Frame &frame)
+{
+    /* Frame could have been started before the cache was cleared, tiles of coarse frames aren't kept */
+    if (
+        !_bValid
+        || (frame.decimation > 1)
+        || (frame.tileScale != _tileScale)
+        || (frame.valueRange != _valueRange)
+        || (frame.size.height() != _height)
+        || (frame.pixelRatio != _pixelRatio)
+        || (frame.bAntialiased != _bAntialiased)
+        || (frame.bDensity != _bDensity)
+        )
+    {
+        return;
+    }
+
+    dropChangedTiles(&_compositeTiles, firstChangedTile(_compositeGraphs, frame.graphs));
+    _compositeGraphs = frame.graphs;
+
+    /* Drop graphs that aren't drawn anymore, the cache shouldn't keep their data alive */
+    QHash<const QCPGraphDataContainer *, GraphTiles>::iterator graphIt = _graphTiles.begin();
+    while (graphIt != _graphTiles.end())
+    {
+        bool bFound = false;
+        foreach(const GraphRasterizer::GraphLayer &graph, frame.graphs)
+        {
+            if (graph.pDataMap.data() == graphIt.key())
+            {
+                bFound = true;
+                break;
+            }
+        }
+
+        if (bFound)
+        {
+            graphIt++;
+        }
+        else
+        {
+            graphIt = _graphTiles.erase(graphIt);
+        }
+    }
+
+    foreach(const GraphRasterizer::Tile &tile, frame.tiles)
+    {
+        if (!tile.image.isNull())
+        {
+            _compositeTiles.insert(tile.index, tile.image);
+        }
+
+        for (qint32 graphIdx = 0; graphIdx < qMin(tile.graphImages.size(), frame.graphs.size()); graphIdx++)
+        {
+            if (!tile.graphImages[graphIdx].isNull())
+            {
+                const GraphRasterizer::GraphLayer &graph = frame.graphs[graphIdx];
+                GraphTiles &graphTiles = _graphTiles[graph.pDataMap.data()];
+
+                if (!GraphRasterizer::isSameGraph(graphTiles.graph, graph))
+                {
+                    dropChangedTiles(&graphTiles.tiles, firstChangedTile(graphTiles.graph, graph));
+                    graphTiles.graph = graph;
+                }
+
+                graphTiles.tiles.insert(tile.index, tile.graphImages[graphIdx]);
+            }
+        }
+    }
+}
+
+/*!
+ * Drop tiles farthest from \a centerIndex until cache fits in budget
+ */
+void TileCache::trim(qint64 centerIndex)
+{
+    const qint64 tileBytes = static_cast<qint64>(GraphRasterizer::cTileWidth * _pixelRatio) * static_cast<qint64>(_height * _pixelRatio) * 4;
+
+    if (tileBytes <= 0)
+    {
+        return;
+    }
+
+    const qint32 maxCompositeTiles = static_cast<qint32>(_cCompositeCacheBytes / tileBytes);
+    if (_compositeTiles.size() > maxCompositeTiles)
+    {
+        foreach(qint64 index, farthestTiles(_compositeTiles.keys(), centerIndex, _compositeTiles.size() - maxCompositeTiles))
+        {
+            _compositeTiles.remove(index);
+        }
+    }
+
+    /* Graph tiles share one budget, drop column of tiles of all graphs at once */
+    qint32 graphTileCount = 0;
+    QSet<qint64> indexSet;
+    foreach(const GraphTiles &graphTiles, _graphTiles)
+    {
+        graphTileCount += graphTiles.tiles.size();
+        indexSet.unite(QSet<qint64>::fromList(graphTiles.tiles.keys()));
+    }
+
+    const qint32 maxGraphTiles = static_cast<qint32>(_cGraphCacheBytes / tileBytes);
+    if (graphTileCount > maxGraphTiles)
+    {
+        const QList<qint64> indexList = indexSet.toList();
+
+        foreach(qint64 index, farthestTiles(indexList, centerIndex, indexList.size()))
+        {
+            QHash<const QCPGraphDataContainer *, GraphTiles>::iterator graphIt;
+            for (graphIt = _graphTiles.begin(); graphIt != _graphTiles.end(); graphIt++)
+            {
+                graphTileCount -= graphIt->tiles.remove(index);
+            }
+
+            if (graphTileCount <= maxGraphTiles)
+            {
+                break;
+            }
+        }
+    }
+}
+
+void TileCache::clear()
+{
+    _bValid = false;
+    _compositeTiles.clear();
+    _compositeGraphs.clear();
+    _graphTiles.clear();
+}
+
+/*!
+ * Index of first tile that changed between \a previous and \a graph
+ * Tiles left of the last point that is neither modified nor appended since \a previous are unchanged
+ */
+qint64 TileCache::firstChangedTile(const GraphRasterizer::GraphLayer &previous, const GraphRasterizer::GraphLayer &graph) const
+{
+    if (GraphRasterizer::isSameGraph(previous, graph))
+    {
+        return std::numeric_limits<qint64>::max();
+    }
+
+    if (
+        (previous.pDataMap == graph.pDataMap)
+        && (!graph.pDataIndex.isNull())
+        && (previous.pen == graph.pen)
+        && (previous.gain == graph.gain)
+        && (previous.offset == graph.offset)
+        && (previous.scatterSize == graph.scatterSize)
+        && (previous.dataSize > 0)
+        && (graph.dataSize >= previous.dataSize)
+        )
+    {
+        /* Points before the first modified one are unchanged, data is only modified by the GUI thread */
+        const qint32 lastSameIdx = qMin(graph.pDataIndex->firstChangedSample(previous.dataRevision), previous.dataSize) - 1;
+
+        if ((lastSameIdx >= 0) && (lastSameIdx < graph.pDataMap->size()))
+        {
+            const double lastSameKey = graph.pDataMap->at(lastSameIdx)->key;
+
+            /* Line from last unchanged point to next point starts in this tile */
+            qint64 index = GraphRasterizer::tileIndex(lastSameKey, _tileScale);
+
+            /* Tile on the left also draws up to the first point on its right border */
+            if (GraphRasterizer::tileKey(index, _tileScale) >= lastSameKey)
+            {
+                index--;
+            }
+
+            return index;
+        }
+    }
+
+    return std::numeric_limits<qint64>::min();
+}
+
+qint64 TileCache::firstChangedTile(const QList<GraphRasterizer::GraphLayer> &previousGraphs, const QList<GraphRasterizer::GraphLayer> &graphs) const
+{
+    if (graphs.size() != previousGraphs.size())
+    {
+        return std::numeric_limits<qint64>::min();
+    }
+
+    qint64 firstIndex = std::numeric_limits<qint64>::max();
+    for (qint32 idx = 0; idx < graphs.size(); idx++)
+    {
+        firstIndex = qMin(firstIndex, firstChangedTile(previousGraphs[idx], graphs[idx]));
+    }
+
+    return firstIndex;
+}
+
+/*!
+ * Remove tiles from \a firstIndex onwards
+ */
+void TileCache::dropChangedTiles(QHash<qint64, QImage> * pTiles, qint64 firstIndex)
+{
+    if (firstIndex == std::numeric_limits<qint64>::min())
+    {
+        pTiles->clear();
+    }
+    else if (firstIndex != std::numeric_limits<qint64>::max())
+    {
+        QHash<qint64, QImage>::iterator it = pTiles->begin();
+        while (it != pTiles->end())
+        {
+            if (it.key() >= firstIndex)
+            {
+                it = pTiles->erase(it);
+            }
+            else
+            {
+                it++;
+            }
+        }
+    }
+    else
+    {
+        // Nothing changed
+    }
+}
+
+/*!
+ * Return \a count entries of \a indexList that are farthest from \a centerIndex
+ */
+QList<qint64> TileCache::farthestTiles(const QList<qint64> &indexList, qint64 centerIndex, qint32 count)
+{
+    QList<qint64> sortedList = indexList;
+
+    std::sort(sortedList.begin(), sortedList.end(), [centerIndex](qint64 left, qint64 right)
+    {
+        return qAbs(left - centerIndex) > qAbs(right - centerIndex);
+    });
+
+    return sortedList.mid(0, count);
+}
@@ -0,0 +1,68 @@
+#ifndef TILECACHE_H
+#define TILECACHE_H
+
+#include <QHash>
+#include "graphrasterizer.h"
+
+/*
+ * Keeps rendered tiles of GraphRasterizer between frames (GUI thread only)
+ *
+ * Composited tiles are kept for the last list of graphs, images of single graphs
+ * are kept per graph. All tiles are dropped when the zoom level, value range,
+ * height or render settings change. When a budget is exceeded, tiles farthest
+ * from the visible range are dropped first.
+ *
+ * When data is appended to a graph or its last points are modified (live update), the tiles
+ * left of the last unchanged point stay valid, the data index of the graph tells which points
+ * are modified since the revision of the previous frame. In a live sliding window only the
+ * tiles with new data are rendered again. Other changes of a graph only drop the tiles of
+ * that graph and the composited tiles.
+ * */
+class TileCache
+{
+
+public:
+    TileCache();
+
+    double tileScale(const GraphRasterizer::Frame &frame);
+    GraphRasterizer::Tile tile(const QList<GraphRasterizer::GraphLayer> &graphs, qint64 index) const;
+    bool contains(const QList<GraphRasterizer::GraphLayer> &graphs, qint64 index) const;
+
+    void insert(const GraphRasterizer::Frame &frame);
+    void trim(qint64 centerIndex);
+    void clear();
+
+private:
+
+    typedef struct
+    {
+        GraphRasterizer::GraphLayer graph;
+        QHash<qint64, QImage> tiles;
+
+    } GraphTiles;
+
+    qint64 firstChangedTile(const GraphRasterizer::GraphLayer &previous, const GraphRasterizer::GraphLayer &graph) const;
+    qint64 firstChangedTile(const QList<GraphRasterizer::GraphLayer> &previousGraphs, const QList<GraphRasterizer::GraphLayer> &graphs) const;
+    static void dropChangedTiles(QHash<qint64, QImage> * pTiles, qint64 firstIndex);
+    static QList<qint64> farthestTiles(const QList<qint64> &indexList, qint64 centerIndex, qint32 count);
+
+    bool _bValid;
+    double _tileScale;
+    QCPRange _valueRange;
+    qint32 _height;
+    double _pixelRatio;
+    bool _bAntialiased;
+    bool _bDensity;
+
+    QList<GraphRasterizer::GraphLayer> _compositeGraphs;
+    QHash<qint64, QImage> _compositeTiles;
+
+    QHash<const QCPGraphDataContainer *, GraphTiles> _graphTiles;
+
+    static const double _cScaleTolerance;
+    static const qint64 _cCompositeCacheBytes = 64 * 1024 * 1024;
+    static const qint64 _cGraphCacheBytes = 128 * 1024 * 1024;
+
+};
+
+#endif // TILECACHE_H
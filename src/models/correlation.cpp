@@ -0,0 +1,309 @@
+
+#include <QtConcurrent>
+#include <QtMath>
+
+#include "graphdataindex.h"
+#include "correlation.h"
+
+/*!
+ * Calculate correlation of all pairs of \a inputs, for the samples with index [beginIdx, endIdx[
+ * When \a pGeneration is set, the calculation stops (invalid result) as soon as it differs from \a generation
+ * \a pDataLock is taken for reading while samples are read, the calculation stops (invalid result) when samples were modified
+ */
+Correlation::Result Correlation::calculate(const QVector<Input> &inputs, qint32 beginIdx, qint32 endIdx, QReadWriteLock * pDataLock,
+                                           const QAtomicInt * pGeneration, qint32 generation)
+{
+    const qint32 columnCount = inputs.size();
+
+    Result result;
+    result.bValid = false;
+    result.columnCount = columnCount;
+    result.sampleCount = qMax(0, endIdx - beginIdx);
+
+    QReadLocker locker(pDataLock);
+
+    if (isDataChanged(inputs))
+    {
+        return result;
+    }
+
+    QVector<Column> columns(columnCount);
+    for (qint32 idx = 0; idx < columnCount; idx++)
+    {
+        columns[idx].input = inputs[idx];
+        columns[idx].beginIdx = beginIdx;
+        columns[idx].endIdx = qMin(endIdx, inputs[idx].pDataMap->size());
+    }
+
+    QtConcurrent::blockingMap(columns, calculateColumnStatistics);
+
+    locker.unlock();
+
+    /* Slab holds all tiles for a number of rows, limited by memory */
+    const qint32 tileCount = (columnCount + _cTileSize - 1) / _cTileSize;
+    const qint32 bytesPerRow = qMax(1, tileCount) * _cTileSize * static_cast<qint32>(sizeof(float));
+    const qint32 blockCount = qMin((result.sampleCount + _cRowBlock - 1) / _cRowBlock, qMax(1, _cSlabBytes / bytesPerRow / _cRowBlock));
+    const qint32 slabRows = blockCount * _cRowBlock;
+
+    QVector<float> slab(tileCount * _cTileSize * slabRows, 0);
+
+    QVector<Task> loadTasks;
+    QVector<Task> pairTasks;
+    for (qint32 tileI = 0; tileI < tileCount; tileI++)
+    {
+        Task task;
+        task.pColumns = &columns;
+        task.pSlab = slab.data();
+        task.slabRows = slabRows;
+        task.slabBeginIdx = beginIdx;
+        task.slabRowCount = 0;
+        task.tileI = tileI;
+        task.tileJ = tileI;
+
+        loadTasks.append(task);
+
+        for (qint32 tileJ = tileI; tileJ < tileCount; tileJ++)
+        {
+            task.tileJ = tileJ;
+            task.sums.fill(0, _cTileSize * _cTileSize);
+
+            pairTasks.append(task);
+        }
+    }
+
+    for (qint32 slabBeginIdx = beginIdx; slabBeginIdx < endIdx; slabBeginIdx += slabRows)
+    {
+        if ((pGeneration != NULL) && (pGeneration->load() != generation))
+        {
+            /* Request is outdated */
+            return result;
+        }
+
+        const qint32 rowCount = qMin(slabRows, endIdx - slabBeginIdx);
+
+        for (qint32 idx = 0; idx < loadTasks.size(); idx++)
+        {
+            loadTasks[idx].slabBeginIdx = slabBeginIdx;
+            loadTasks[idx].slabRowCount = rowCount;
+        }
+
+        for (qint32 idx = 0; idx < pairTasks.size(); idx++)
+        {
+            pairTasks[idx].slabRowCount = rowCount;
+        }
+
+        locker.relock();
+
+        if (isDataChanged(inputs))
+        {
+            /* Samples were modified since the request */
+            return result;
+        }
+
+        QtConcurrent::blockingMap(loadTasks, loadTile);
+
+        locker.unlock();
+
+        QtConcurrent::blockingMap(pairTasks, calculateTile);
+    }
+
+    result.coefficients.fill(qQNaN(), columnCount * columnCount);
+
+    foreach(const Task &task, pairTasks)
+    {
+        for (qint32 i = 0; i < _cTileSize; i++)
+        {
+            const qint32 columnI = task.tileI * _cTileSize + i;
+            if (columnI >= columnCount)
+            {
+                break;
+            }
+
+            for (qint32 j = 0; j < _cTileSize; j++)
+            {
+                const qint32 columnJ = task.tileJ * _cTileSize + j;
+                if (columnJ >= columnCount)
+                {
+                    break;
+                }
+
+                if ((columns[columnI].scale > 0) && (columns[columnJ].scale > 0))
+                {
+                    const double coefficient = qBound(-1.0, task.sums[i * _cTileSize + j], 1.0);
+
+                    result.coefficients[columnI * columnCount + columnJ] = coefficient;
+                    result.coefficients[columnJ * columnCount + columnI] = coefficient;
+                }
+            }
+        }
+    }
+
+    for (qint32 idx = 0; idx < columnCount; idx++)
+    {
+        if (columns[idx].scale > 0)
+        {
+            result.coefficients[idx * columnCount + idx] = 1;
+        }
+    }
+
+    result.bValid = true;
+
+    return result;
+}
+
+/*!
+ * Check whether samples of \a inputs were modified since the request, the data lock should be held
+ */
+bool Correlation::isDataChanged(const QVector<Input> &inputs)
+{
+    foreach(const Input &input, inputs)
+    {
+        if ((input.pDataIndex != NULL) && (input.pDataIndex->revision() != input.revision))
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+/*!
+ * Mean and scale of the samples of a column that aren't missing
+ */
+void Correlation::calculateColumnStatistics(Column &column)
+{
+    const QCPGraphDataContainer::const_iterator beginIt = column.input.pDataMap->constBegin() + column.beginIdx;
+    const QCPGraphDataContainer::const_iterator endIt = column.input.pDataMap->constBegin() + qMax(column.beginIdx, column.endIdx);
+
+    double sum = 0;
+    qint32 count = 0;
+    for (QCPGraphDataContainer::const_iterator it = beginIt; it < endIt; it++)
+    {
+        if (!qIsNaN(it->value))
+        {
+            sum += it->value;
+            count++;
+        }
+    }
+
+    column.mean = 0;
+    column.scale = 0;
+
+    if (count > 1)
+    {
+        const double mean = sum / count;
+
+        double squaredSum = 0;
+        for (QCPGraphDataContainer::const_iterator it = beginIt; it < endIt; it++)
+        {
+            if (!qIsNaN(it->value))
+            {
+                squaredSum += (it->value - mean) * (it->value - mean);
+            }
+        }
+
+        /* Gain and offset are applied to the statistics: only the sign of the gain remains */
+        column.mean = column.input.gain * mean + column.input.offset;
+
+        const double scaledSquaredSum = column.input.gain * column.input.gain * squaredSum;
+        if (scaledSquaredSum > 0)
+        {
+            column.scale = 1 / qSqrt(scaledSquaredSum);
+        }
+    }
+}
+
+/*!
+ * Copy standardized values of the columns of a tile to the slab, missing samples are 0
+ * Rows are padded with 0 to a multiple of _cRowBlock
+ * The slab is filled block by block, so the rows that are written stay in cache
+ */
+void Correlation::loadTile(Task &task)
+{
+    const QVector<Column> &columns = *task.pColumns;
+    float * pTile = task.pSlab + task.tileI * task.slabRows * _cTileSize;
+
+    for (qint32 blockBegin = 0; blockBegin < task.slabRowCount; blockBegin += _cRowBlock)
+    {
+        const qint32 blockEnd = blockBegin + _cRowBlock;
+
+        for (qint32 lane = 0; lane < _cTileSize; lane++)
+        {
+            const qint32 columnIdx = task.tileI * _cTileSize + lane;
+            if (columnIdx >= columns.size())
+            {
+                /* Padding columns stay 0 */
+                break;
+            }
+
+            const Column &column = columns[columnIdx];
+            const qint32 availableEnd = column.scale > 0 ? qBound(blockBegin, column.endIdx - task.slabBeginIdx, qMin(blockEnd, task.slabRowCount)) : blockBegin;
+            const double gain = column.input.gain * column.scale;
+            const double offset = (column.input.offset - column.mean) * column.scale;
+
+            qint32 row = blockBegin;
+            if (availableEnd > row)
+            {
+                const QCPGraphData * pData = column.input.pDataMap->constBegin() + task.slabBeginIdx;
+
+                for (; row < availableEnd; row++)
+                {
+                    const double value = pData[row].value;
+                    pTile[row * _cTileSize + lane] = qIsNaN(value) ? 0 : static_cast<float>(gain * value + offset);
+                }
+            }
+
+            for (; row < blockEnd; row++)
+            {
+                pTile[row * _cTileSize + lane] = 0;
+            }
+        }
+    }
+}
+
+/*!
+ * Add products of the columns of two tiles for all rows in the slab
+ * Blocks of 4 x 8 pairs are kept in registers for _cRowBlock rows
+ */
+void Correlation::calculateTile(Task &task)
+{
+    const float * pTileI = task.pSlab + task.tileI * task.slabRows * _cTileSize;
+    const float * pTileJ = task.pSlab + task.tileJ * task.slabRows * _cTileSize;
+    double * pSums = task.sums.data();
+
+    for (qint32 blockBegin = 0; blockBegin < task.slabRowCount; blockBegin += _cRowBlock)
+    {
+        const float * pBlockI = pTileI + blockBegin * _cTileSize;
+        const float * pBlockJ = pTileJ + blockBegin * _cTileSize;
+
+        for (qint32 i0 = 0; i0 < _cTileSize; i0 += 4)
+        {
+            for (qint32 j0 = 0; j0 < _cTileSize; j0 += 8)
+            {
+                float blockSums[4][8] = {};
+
+                for (qint32 row = 0; row < _cRowBlock; row++)
+                {
+                    const float * pRowI = pBlockI + row * _cTileSize + i0;
+                    const float * pRowJ = pBlockJ + row * _cTileSize + j0;
+
+                    for (qint32 i = 0; i < 4; i++)
+                    {
+                        for (qint32 j = 0; j < 8; j++)
+                        {
+                            blockSums[i][j] += pRowI[i] * pRowJ[j];
+                        }
+                    }
+                }
+
+                for (qint32 i = 0; i < 4; i++)
+                {
+                    for (qint32 j = 0; j < 8; j++)
+                    {
+                        pSums[(i0 + i) * _cTileSize + j0 + j] += blockSums[i][j];
+                    }
+                }
+            }
+        }
+    }
+}
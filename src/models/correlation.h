@@ -0,0 +1,92 @@
+#ifndef CORRELATION_H
+#define CORRELATION_H
+
+#include <QVector>
+#include <QAtomicInt>
+#include <QReadWriteLock>
+#include "qcustomplot.h"
+
+/* Forward declaration */
+class GraphDataIndex;
+
+/*
+ * Pearson correlation matrix of graphs that share their keys
+ *
+ * Every column is standardized with its mean and deviation, so the correlation is the sum of products.
+ * The samples are processed in slabs of rows: the standardized values of all columns are copied
+ * to a float buffer once per slab, then tiles of _cTileSize x _cTileSize column pairs are
+ * calculated in parallel. The products of a block of rows are summed in float registers and
+ * accumulated in double per tile.
+ *
+ * NaN samples and samples after the end of a shorter graph are missing:
+ * they are replaced by the mean of the column, so they don't contribute to the sums.
+ *
+ * The data lock is only held while samples are read: during the column statistics and while a slab
+ * is loaded. Every time the lock is taken, the revision of the data indexes is compared with the
+ * revision of the request. When samples were modified in the meantime, the result is invalid.
+ * */
+class Correlation
+{
+
+public:
+
+    typedef struct
+    {
+        const QCPGraphDataContainer * pDataMap;
+        const GraphDataIndex * pDataIndex; // NULL when samples aren't modified during the calculation
+        quint32 revision; // Revision of pDataIndex when the request was made
+        double gain;
+        double offset;
+
+    } Input;
+
+    typedef struct
+    {
+        bool bValid;
+        qint32 columnCount;
+        qint32 sampleCount;
+        QVector<double> coefficients; // columnCount x columnCount, NaN when a column is constant or empty
+
+    } Result;
+
+    static Result calculate(const QVector<Input> &inputs, qint32 beginIdx, qint32 endIdx, QReadWriteLock * pDataLock = NULL,
+                            const QAtomicInt * pGeneration = NULL, qint32 generation = 0);
+
+private:
+
+    typedef struct
+    {
+        Input input;
+        qint32 beginIdx;
+        qint32 endIdx;
+        double mean;
+        double scale; // 1 / sqrt(sum of squared deviations), 0 when constant or empty
+
+    } Column;
+
+    typedef struct
+    {
+        const QVector<Column> * pColumns;
+        float * pSlab;
+        qint32 slabRows; // capacity of slab per tile
+        qint32 slabBeginIdx;
+        qint32 slabRowCount;
+        qint32 tileI;
+        qint32 tileJ;
+        QVector<double> sums; // _cTileSize x _cTileSize
+
+    } Task;
+
+    static bool isDataChanged(const QVector<Input> &inputs);
+    static void calculateColumnStatistics(Column &column);
+    static void loadTile(Task &task);
+    static void calculateTile(Task &task);
+
+    /* Compile time constants, so the loops of the tile calculation are vectorized */
+    static const qint32 _cTileSize = 32;
+    static const qint32 _cRowBlock = 256;
+    static const qint32 _cSlabBytes = 64 * 1024 * 1024;
+
+};
+
+#endif // CORRELATION_H
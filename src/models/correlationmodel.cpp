@@ -0,0 +1,167 @@
+
+#include <QColor>
+
+#include "graphdatamodel.h"
+#include "correlationmodel.h"
+
+CorrelationModel::CorrelationModel(GraphDataModel * pGraphDataModel, QObject *parent) : QAbstractTableModel(parent)
+{
+    _pGraphDataModel = pGraphDataModel;
+}
+
+int CorrelationModel::rowCount(const QModelIndex &parent) const
+{
+    if (parent.isValid())
+    {
+        return 0;
+    }
+
+    return _graphList.size();
+}
+
+int CorrelationModel::columnCount(const QModelIndex &parent) const
+{
+    if (parent.isValid())
+    {
+        return 0;
+    }
+
+    return _graphList.size();
+}
+
+QVariant CorrelationModel::data(const QModelIndex &index, int role) const
+{
+    if (
+        !index.isValid()
+        || (index.row() >= _graphList.size())
+        || (index.column() >= _graphList.size())
+        )
+    {
+        return QVariant();
+    }
+
+    const double coefficient = _coefficients[index.row() * _graphList.size() + index.column()];
+
+    switch (role)
+    {
+    case Qt::DisplayRole:
+        if (!qIsNaN(coefficient))
+        {
+            return QString::number(coefficient, 'f', 2);
+        }
+        break;
+
+    case Qt::ToolTipRole:
+        if (isValidGraph(index.row()) && isValidGraph(index.column()))
+        {
+            return QString("%1 - %2: %3")
+                    .arg(_pGraphDataModel->label(_graphList[index.row()]))
+                    .arg(_pGraphDataModel->label(_graphList[index.column()]))
+                    .arg(qIsNaN(coefficient) ? QString("constant or no samples") : QString::number(coefficient, 'f', 4));
+        }
+        break;
+
+    case Qt::BackgroundRole:
+        if (!qIsNaN(coefficient))
+        {
+            /* Fade from white to red (positive) or blue (negative) */
+            const qint32 fade = 255 - qRound(qAbs(coefficient) * 255);
+            if (coefficient >= 0)
+            {
+                return QColor(255, fade, fade);
+            }
+            else
+            {
+                return QColor(fade, fade, 255);
+            }
+        }
+        break;
+
+    case Qt::TextAlignmentRole:
+        return Qt::AlignCenter;
+
+    default:
+        break;
+    }
+
+    return QVariant();
+}
+
+QVariant CorrelationModel::headerData(int section, Qt::Orientation orientation, int role) const
+{
+    Q_UNUSED(orientation);
+
+    if (isValidGraph(section))
+    {
+        if (role == Qt::DisplayRole)
+        {
+            return _pGraphDataModel->label(_graphList[section]);
+        }
+        else if (role == Qt::DecorationRole)
+        {
+            return _pGraphDataModel->color(_graphList[section]);
+        }
+    }
+
+    return QVariant();
+}
+
+qint32 CorrelationModel::graphIndex(qint32 section) const
+{
+    if (isValidGraph(section))
+    {
+        return _graphList[section];
+    }
+
+    return -1;
+}
+
+/*!
+ * Show \a result, calculated for the graphs in \a graphList
+ */
+void CorrelationModel::setCorrelation(const QList<quint16> &graphList, const Correlation::Result &result)
+{
+    beginResetModel();
+
+    _graphList.clear();
+    foreach(quint16 graphIdx, graphList)
+    {
+        _graphList.append(graphIdx);
+    }
+
+    _coefficients = result.coefficients;
+
+    endResetModel();
+}
+
+void CorrelationModel::clear()
+{
+    beginResetModel();
+
+    _graphList.clear();
+    _coefficients.clear();
+
+    endResetModel();
+}
+
+/*!
+ * Labels or colors of graphs have changed
+ */
+void CorrelationModel::updateHeaders()
+{
+    if (!_graphList.isEmpty())
+    {
+        emit headerDataChanged(Qt::Horizontal, 0, _graphList.size() - 1);
+        emit headerDataChanged(Qt::Vertical, 0, _graphList.size() - 1);
+    }
+}
+
+/*!
+ * Graph of row or column still exists (graphs can be removed before the correlation is calculated again)
+ */
+bool CorrelationModel::isValidGraph(qint32 section) const
+{
+    return (section >= 0)
+            && (section < _graphList.size())
+            && (_graphList[section] < _pGraphDataModel->size());
+}
@@ -0,0 +1,47 @@
+#ifndef CORRELATIONMODEL_H
+#define CORRELATIONMODEL_H
+
+#include <QAbstractTableModel>
+#include <QVector>
+
+#include "correlation.h"
+
+/* Forward declaration */
+class GraphDataModel;
+
+/*
+ * Table model of a correlation matrix with one row and one column per graph
+ *
+ * Labels and colors are taken from the graph data model when the view requests them.
+ * Cells are colored from blue (-1) over white (0) to red (+1).
+ * */
+class CorrelationModel : public QAbstractTableModel
+{
+    Q_OBJECT
+public:
+    explicit CorrelationModel(GraphDataModel * pGraphDataModel, QObject *parent = 0);
+
+    int rowCount(const QModelIndex &parent = QModelIndex()) const;
+    int columnCount(const QModelIndex &parent = QModelIndex()) const;
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const;
+    QVariant headerData(int section, Qt::Orientation orientation, int role) const;
+
+    qint32 graphIndex(qint32 section) const;
+
+    void setCorrelation(const QList<quint16> &graphList, const Correlation::Result &result);
+    void clear();
+
+public slots:
+    void updateHeaders();
+
+private:
+    bool isValidGraph(qint32 section) const;
+
+    GraphDataModel * _pGraphDataModel;
+
+    QVector<qint32> _graphList; // graph index per row and column
+    QVector<double> _coefficients;
+
+};
+
+#endif // CORRELATIONMODEL_H
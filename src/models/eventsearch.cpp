@@ -0,0 +1,202 @@
+
+#include <QtConcurrent>
+
+#include "eventsearch.h"
+
+/*
+ * Conditions on raw sample values, evaluated without branches
+ * NaN samples never match, except for the NaN condition
+ * */
+struct RisingCondition
+{
+    double level;
+    bool operator()(double previous, double current) const { return (previous < level) & (current >= level); }
+};
+
+struct FallingCondition
+{
+    double level;
+    bool operator()(double previous, double current) const { return (previous > level) & (current <= level); }
+};
+
+struct CrossingCondition
+{
+    double level;
+    bool operator()(double previous, double current) const
+    {
+        return ((previous < level) & (current >= level)) | ((previous > level) & (current <= level));
+    }
+};
+
+struct ChangeCondition
+{
+    double delta;
+    bool operator()(double previous, double current) const { return qAbs(current - previous) > delta; }
+};
+
+struct NanCondition
+{
+    bool operator()(double previous, double current) const { return (previous == previous) & (current != current); }
+};
+
+/*!
+ * Search events of \a type in graph, \a value is in shown units (gain and offset applied)
+ * At most \a maxHits events are returned, in order of the samples
+ */
+EventSearch::Result EventSearch::search(const QCPGraphDataContainer * pDataMap, double gain, double offset, SearchType type, double value, qint32 maxHits)
+{
+    Result result;
+    result.bTruncated = false;
+
+    const qint32 sampleCount = pDataMap->size();
+
+    if ((sampleCount == 0) || (maxHits <= 0))
+    {
+        return result;
+    }
+
+    if ((type == SEARCH_NAN) && qIsNaN(pDataMap->constBegin()->value))
+    {
+        result.indices.append(0);
+    }
+
+    if ((gain == 0) && (type != SEARCH_NAN))
+    {
+        /* Shown value is constant */
+        return result;
+    }
+
+    /* Convert value to raw samples once, instead of scaling every sample */
+    const double rawLevel = (value - offset) / gain;
+    if (gain < 0)
+    {
+        if (type == SEARCH_RISING)
+        {
+            type = SEARCH_FALLING;
+        }
+        else if (type == SEARCH_FALLING)
+        {
+            type = SEARCH_RISING;
+        }
+    }
+
+    QVector<Chunk> chunks;
+    for (qint32 beginIdx = 1; beginIdx < sampleCount; beginIdx += _cChunkSize)
+    {
+        Chunk chunk;
+        chunk.pData = pDataMap->constBegin();
+        chunk.beginIdx = beginIdx;
+        chunk.endIdx = qMin(beginIdx + _cChunkSize, sampleCount);
+        chunk.maxHits = maxHits;
+
+        chunks.append(chunk);
+    }
+
+    switch (type)
+    {
+    case SEARCH_RISING:
+    {
+        const RisingCondition condition = { rawLevel };
+        QtConcurrent::blockingMap(chunks, [condition](Chunk &chunk) { scanChunk(chunk, condition); });
+        break;
+    }
+    case SEARCH_FALLING:
+    {
+        const FallingCondition condition = { rawLevel };
+        QtConcurrent::blockingMap(chunks, [condition](Chunk &chunk) { scanChunk(chunk, condition); });
+        break;
+    }
+    case SEARCH_CROSSING:
+    {
+        const CrossingCondition condition = { rawLevel };
+        QtConcurrent::blockingMap(chunks, [condition](Chunk &chunk) { scanChunk(chunk, condition); });
+        break;
+    }
+    case SEARCH_CHANGE:
+    {
+        const ChangeCondition condition = { value / qAbs(gain) };
+        QtConcurrent::blockingMap(chunks, [condition](Chunk &chunk) { scanChunk(chunk, condition); });
+        break;
+    }
+    case SEARCH_NAN:
+    {
+        const NanCondition condition = NanCondition();
+        QtConcurrent::blockingMap(chunks, [condition](Chunk &chunk) { scanChunk(chunk, condition); });
+        break;
+    }
+    default:
+        break;
+    }
+
+    foreach(const Chunk &chunk, chunks)
+    {
+        const qint32 count = qMin(chunk.indices.size(), maxHits - result.indices.size());
+
+        result.indices += chunk.indices.mid(0, count);
+
+        if (count < chunk.indices.size())
+        {
+            result.bTruncated = true;
+            break;
+        }
+    }
+
+    return result;
+}
+
+QString EventSearch::typeName(SearchType type)
+{
+    switch (type)
+    {
+    case SEARCH_RISING:
+        return QString("Rises to value");
+    case SEARCH_FALLING:
+        return QString("Falls to value");
+    case SEARCH_CROSSING:
+        return QString("Crosses value");
+    case SEARCH_CHANGE:
+        return QString("Changes more than value");
+    case SEARCH_NAN:
+        return QString("Becomes NaN");
+    default:
+        return QString();
+    }
+}
+
+/*!
+ * Collect indices of samples in chunk that match \a condition, stops after maxHits + 1 matches
+ * (one more than needed, so truncation is detected)
+ */
+template <typename Condition>
+void EventSearch::scanChunk(Chunk &chunk, Condition condition)
+{
+    const QCPGraphData * pData = chunk.pData;
+
+    for (qint32 blockBegin = chunk.beginIdx; blockBegin < chunk.endIdx; blockBegin += _cBlockSize)
+    {
+        const qint32 blockEnd = qMin(blockBegin + _cBlockSize, chunk.endIdx);
+
+        /* Most blocks have no events: only count them */
+        qint32 count = 0;
+        for (qint32 idx = blockBegin; idx < blockEnd; idx++)
+        {
+            count += condition(pData[idx - 1].value, pData[idx].value);
+        }
+
+        if (count > 0)
+        {
+            for (qint32 idx = blockBegin; idx < blockEnd; idx++)
+            {
+                if (condition(pData[idx - 1].value, pData[idx].value))
+                {
+                    chunk.indices.append(idx);
+
+                    if (chunk.indices.size() > chunk.maxHits)
+                    {
+                        return;
+                    }
+                }
+            }
+        }
+    }
+}
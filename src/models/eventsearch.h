@@ -0,0 +1,64 @@
+#ifndef EVENTSEARCH_H
+#define EVENTSEARCH_H
+
+#include <QVector>
+#include <QString>
+#include "qcustomplot.h"
+
+/*
+ * Search for events in the samples of a graph
+ *
+ * An event is found at sample idx when the transition from sample idx - 1 to sample idx matches.
+ * The graph is split in chunks that are scanned in parallel. Every chunk is checked in blocks:
+ * the matches of a block are counted with a branchless loop that the compiler vectorizes,
+ * only blocks with matches are scanned again to collect the sample indices.
+ * */
+class EventSearch
+{
+
+public:
+
+    typedef enum
+    {
+        SEARCH_RISING = 0, // rises to or above value
+        SEARCH_FALLING, // falls to or below value
+        SEARCH_CROSSING, // rises or falls through value
+        SEARCH_CHANGE, // changes more than value
+        SEARCH_NAN, // becomes NaN (value is ignored)
+
+        SEARCH_TYPE_COUNT
+    } SearchType;
+
+    typedef struct
+    {
+        QVector<qint32> indices;
+        bool bTruncated; // more than maxHits events
+
+    } Result;
+
+    static Result search(const QCPGraphDataContainer * pDataMap, double gain, double offset, SearchType type, double value, qint32 maxHits);
+
+    static QString typeName(SearchType type);
+
+private:
+
+    typedef struct
+    {
+        const QCPGraphData * pData;
+        qint32 beginIdx;
+        qint32 endIdx;
+        qint32 maxHits;
+        QVector<qint32> indices;
+
+    } Chunk;
+
+    template <typename Condition>
+    static void scanChunk(Chunk &chunk, Condition condition);
+
+    /* Compile time constants, so the count loop is vectorized */
+    static const qint32 _cChunkSize = 1024 * 1024;
+    static const qint32 _cBlockSize = 256;
+
+};
+
+#endif // EVENTSEARCH_H
@@ -0,0 +1,776 @@
+
+#include <QtMath>
+
+#include "graphdatamodel.h"
+#include "expression.h"
+
+const qint32 Expression::cSelfReference = -1;
+const qint32 Expression::_cBlockSize = 1024;
+
+Expression::Expression()
+{
+    _pos = 0;
+    _stackDepth = 0;
+    _maxStackDepth = 0;
+    _stateCount = 0;
+}
+
+/*!
+ * Compile \a source, graphs are referenced by their label in \a labelList
+ * Returns false when the source isn't valid, see errorString()
+ */
+bool Expression::compile(const QString &source, const QStringList &labelList)
+{
+    _source = source;
+    _pos = 0;
+    _error.clear();
+    _labelList = labelList;
+
+    _program.clear();
+    _references.clear();
+    _stackDepth = 0;
+    _maxStackDepth = 0;
+    _stateCount = 0;
+
+    bool bOk = parseComparison();
+
+    if (bOk)
+    {
+        skipWhitespace();
+        if (_pos < _source.size())
+        {
+            bOk = setError(QString("Unexpected '%1' at position %2").arg(_source[_pos]).arg(_pos + 1));
+        }
+    }
+
+    if (!bOk)
+    {
+        _program.clear();
+        _references.clear();
+    }
+
+    return bOk;
+}
+
+bool Expression::isValid() const
+{
+    return !_program.isEmpty();
+}
+
+QString Expression::source() const
+{
+    return _source;
+}
+
+QString Expression::errorString() const
+{
+    return _error;
+}
+
+/*!
+ * Graph index of every input, the inputs passed to evaluate() should follow this order
+ */
+QList<qint32> Expression::references() const
+{
+    return _references;
+}
+
+/*!
+ * Evaluate expression for samples [beginIdx, endIdx[, keys are taken from \a pKeyMap
+ * \a pResult should have room for (endIdx - beginIdx) values
+ *
+ * Doesn't modify the expression, so it can be called from multiple threads
+ */
+void Expression::evaluate(const QVector<Input> &inputs, const QCPGraphDataContainer * pKeyMap, qint32 beginIdx, qint32 endIdx, double * pResult) const
+{
+    if (
+        !isValid()
+        || (inputs.size() != _references.size())
+        )
+    {
+        return;
+    }
+
+    endIdx = qMin(endIdx, pKeyMap->size());
+
+    QVector<double> stack(_maxStackDepth * _cBlockSize);
+    QVector<double> keys(_cBlockSize);
+
+    State initialState;
+    initialState.bValid = false;
+    initialState.key = 0;
+    initialState.value = 0;
+    initialState.sum = 0;
+    QVector<State> states(_stateCount, initialState);
+
+    for (qint32 blockIdx = beginIdx; blockIdx < endIdx; blockIdx += _cBlockSize)
+    {
+        const qint32 count = qMin(_cBlockSize, endIdx - blockIdx);
+
+        QCPGraphDataContainer::const_iterator keyIt = pKeyMap->constBegin() + blockIdx;
+        for (qint32 idx = 0; idx < count; idx++)
+        {
+            keys[idx] = (keyIt + idx)->key;
+        }
+
+        /* Every stack entry is a block of values */
+        qint32 depth = 0;
+        double * pStack = stack.data();
+
+        foreach(const Instruction &instruction, _program)
+        {
+            double * pNew = pStack + depth * _cBlockSize;
+            double * pTop = pStack + qMax(depth - 1, 0) * _cBlockSize;
+            double * pBelow = pStack + qMax(depth - 2, 0) * _cBlockSize;
+
+            switch (instruction.opCode)
+            {
+            case OP_CONSTANT:
+                std::fill(pNew, pNew + count, instruction.constant);
+                depth++;
+                break;
+
+            case OP_KEY:
+                std::copy(keys.constData(), keys.constData() + count, pNew);
+                depth++;
+                break;
+
+            case OP_INPUT:
+                loadInput(pNew, inputs[instruction.operand], blockIdx, count);
+                depth++;
+                break;
+
+            case OP_NEGATE:
+                for (qint32 idx = 0; idx < count; idx++)
+                {
+                    pTop[idx] = -pTop[idx];
+                }
+                break;
+
+            case OP_ADD:
+                for (qint32 idx = 0; idx < count; idx++)
+                {
+                    pBelow[idx] += pTop[idx];
+                }
+                depth--;
+                break;
+
+            case OP_SUBTRACT:
+                for (qint32 idx = 0; idx < count; idx++)
+                {
+                    pBelow[idx] -= pTop[idx];
+                }
+                depth--;
+                break;
+
+            case OP_MULTIPLY:
+                for (qint32 idx = 0; idx < count; idx++)
+                {
+                    pBelow[idx] *= pTop[idx];
+                }
+                depth--;
+                break;
+
+            case OP_DIVIDE:
+                for (qint32 idx = 0; idx < count; idx++)
+                {
+                    pBelow[idx] /= pTop[idx];
+                }
+                depth--;
+                break;
+
+            case OP_POWER:
+                for (qint32 idx = 0; idx < count; idx++)
+                {
+                    pBelow[idx] = qPow(pBelow[idx], pTop[idx]);
+                }
+                depth--;
+                break;
+
+            case OP_LESS:
+                for (qint32 idx = 0; idx < count; idx++)
+                {
+                    pBelow[idx] = pBelow[idx] < pTop[idx] ? 1 : 0;
+                }
+                depth--;
+                break;
+
+            case OP_GREATER:
+                for (qint32 idx = 0; idx < count; idx++)
+                {
+                    pBelow[idx] = pBelow[idx] > pTop[idx] ? 1 : 0;
+                }
+                depth--;
+                break;
+
+            case OP_LESS_EQUAL:
+                for (qint32 idx = 0; idx < count; idx++)
+                {
+                    pBelow[idx] = pBelow[idx] <= pTop[idx] ? 1 : 0;
+                }
+                depth--;
+                break;
+
+            case OP_GREATER_EQUAL:
+                for (qint32 idx = 0; idx < count; idx++)
+                {
+                    pBelow[idx] = pBelow[idx] >= pTop[idx] ? 1 : 0;
+                }
+                depth--;
+                break;
+
+            case OP_EQUAL:
+                for (qint32 idx = 0; idx < count; idx++)
+                {
+                    pBelow[idx] = pBelow[idx] == pTop[idx] ? 1 : 0;
+                }
+                depth--;
+                break;
+
+            case OP_NOT_EQUAL:
+                for (qint32 idx = 0; idx < count; idx++)
+                {
+                    pBelow[idx] = pBelow[idx] != pTop[idx] ? 1 : 0;
+                }
+                depth--;
+                break;
+
+            case OP_ABS:
+                for (qint32 idx = 0; idx < count; idx++)
+                {
+                    pTop[idx] = qAbs(pTop[idx]);
+                }
+                break;
+
+            case OP_SQRT:
+                for (qint32 idx = 0; idx < count; idx++)
+                {
+                    pTop[idx] = qSqrt(pTop[idx]);
+                }
+                break;
+
+            case OP_LOG:
+                for (qint32 idx = 0; idx < count; idx++)
+                {
+                    pTop[idx] = qLn(pTop[idx]);
+                }
+                break;
+
+            case OP_EXP:
+                for (qint32 idx = 0; idx < count; idx++)
+                {
+                    pTop[idx] = qExp(pTop[idx]);
+                }
+                break;
+
+            case OP_MIN:
+                for (qint32 idx = 0; idx < count; idx++)
+                {
+                    pBelow[idx] = qMin(pBelow[idx], pTop[idx]);
+                }
+                depth--;
+                break;
+
+            case OP_MAX:
+                for (qint32 idx = 0; idx < count; idx++)
+                {
+                    pBelow[idx] = qMax(pBelow[idx], pTop[idx]);
+                }
+                depth--;
+                break;
+
+            case OP_DERIVATIVE:
+            case OP_INTEGRAL:
+                runState(pTop, keys.constData(), count, instruction.opCode, &states[instruction.operand]);
+                break;
+
+            default:
+                break;
+            }
+        }
+
+        std::copy(pStack, pStack + count, pResult + (blockIdx - beginIdx));
+    }
+}
+
+bool Expression::parseComparison()
+{
+    if (!parseAdditive())
+    {
+        return false;
+    }
+
+    OpCode opCode;
+    if (accept("<="))
+    {
+        opCode = OP_LESS_EQUAL;
+    }
+    else if (accept(">="))
+    {
+        opCode = OP_GREATER_EQUAL;
+    }
+    else if (accept("=="))
+    {
+        opCode = OP_EQUAL;
+    }
+    else if (accept("!="))
+    {
+        opCode = OP_NOT_EQUAL;
+    }
+    else if (accept("<"))
+    {
+        opCode = OP_LESS;
+    }
+    else if (accept(">"))
+    {
+        opCode = OP_GREATER;
+    }
+    else
+    {
+        return true;
+    }
+
+    if (!parseAdditive())
+    {
+        return false;
+    }
+
+    addInstruction(opCode);
+
+    return true;
+}
+
+bool Expression::parseAdditive()
+{
+    if (!parseTerm())
+    {
+        return false;
+    }
+
+    while (true)
+    {
+        OpCode opCode;
+        if (accept("+"))
+        {
+            opCode = OP_ADD;
+        }
+        else if (accept("-"))
+        {
+            opCode = OP_SUBTRACT;
+        }
+        else
+        {
+            return true;
+        }
+
+        if (!parseTerm())
+        {
+            return false;
+        }
+
+        addInstruction(opCode);
+    }
+}
+
+bool Expression::parseTerm()
+{
+    if (!parseUnary())
+    {
+        return false;
+    }
+
+    while (true)
+    {
+        OpCode opCode;
+        if (accept("*"))
+        {
+            opCode = OP_MULTIPLY;
+        }
+        else if (accept("/"))
+        {
+            opCode = OP_DIVIDE;
+        }
+        else
+        {
+            return true;
+        }
+
+        if (!parseUnary())
+        {
+            return false;
+        }
+
+        addInstruction(opCode);
+    }
+}
+
+bool Expression::parseUnary()
+{
+    if (accept("-"))
+    {
+        if (!parseUnary())
+        {
+            return false;
+        }
+
+        addInstruction(OP_NEGATE);
+        return true;
+    }
+    else if (accept("+"))
+    {
+        return parseUnary();
+    }
+    else
+    {
+        return parsePower();
+    }
+}
+
+bool Expression::parsePower()
+{
+    if (!parsePrimary())
+    {
+        return false;
+    }
+
+    if (accept("^"))
+    {
+        /* Right associative, exponent can have a sign */
+        if (!parseUnary())
+        {
+            return false;
+        }
+
+        addInstruction(OP_POWER);
+    }
+
+    return true;
+}
+
+bool Expression::parsePrimary()
+{
+    skipWhitespace();
+
+    if (_pos >= _source.size())
+    {
+        return setError("Unexpected end of expression");
+    }
+
+    const QChar character = _source[_pos];
+
+    if (accept("("))
+    {
+        if (!parseComparison())
+        {
+            return false;
+        }
+
+        if (!accept(")"))
+        {
+            return setError(QString("Expected ')' at position %1").arg(_pos + 1));
+        }
+    }
+    else if (character == '[')
+    {
+        const qint32 endPos = _source.indexOf(']', _pos + 1);
+        if (endPos == -1)
+        {
+            return setError(QString("Missing ']' after position %1").arg(_pos + 1));
+        }
+
+        const QString label = _source.mid(_pos + 1, endPos - _pos - 1);
+        const qint32 graphIdx = _labelList.indexOf(label);
+        if (graphIdx == -1)
+        {
+            return setError(QString("Unknown graph: %1").arg(label));
+        }
+
+        _pos = endPos + 1;
+
+        if (!_references.contains(graphIdx))
+        {
+            _references.append(graphIdx);
+        }
+        addInstruction(OP_INPUT, _references.indexOf(graphIdx));
+    }
+    else if (character.isDigit() || (character == '.'))
+    {
+        const qint32 startPos = _pos;
+
+        while ((_pos < _source.size()) && (_source[_pos].isDigit() || (_source[_pos] == '.')))
+        {
+            _pos++;
+        }
+
+        /* Exponent */
+        if ((_pos < _source.size()) && (_source[_pos].toLower() == 'e'))
+        {
+            _pos++;
+            if ((_pos < _source.size()) && ((_source[_pos] == '+') || (_source[_pos] == '-')))
+            {
+                _pos++;
+            }
+
+            while ((_pos < _source.size()) && _source[_pos].isDigit())
+            {
+                _pos++;
+            }
+        }
+
+        bool bOk;
+        const double value = _source.mid(startPos, _pos - startPos).toDouble(&bOk);
+        if (!bOk)
+        {
+            return setError(QString("Invalid number at position %1").arg(startPos + 1));
+        }
+
+        addInstruction(OP_CONSTANT, 0, value);
+    }
+    else if (character.isLetter() || (character == '_'))
+    {
+        const qint32 startPos = _pos;
+
+        while ((_pos < _source.size()) && (_source[_pos].isLetterOrNumber() || (_source[_pos] == '_')))
+        {
+            _pos++;
+        }
+
+        const QString name = _source.mid(startPos, _pos - startPos);
+
+        if (accept("("))
+        {
+            return parseFunction(name);
+        }
+        else if (name == "t")
+        {
+            addInstruction(OP_KEY);
+        }
+        else if (name == "y")
+        {
+            if (!_references.contains(cSelfReference))
+            {
+                _references.append(cSelfReference);
+            }
+            addInstruction(OP_INPUT, _references.indexOf(cSelfReference));
+        }
+        else
+        {
+            return setError(QString("Unknown name: %1").arg(name));
+        }
+    }
+    else
+    {
+        return setError(QString("Unexpected '%1' at position %2").arg(character).arg(_pos + 1));
+    }
+
+    return true;
+}
+
+/*!
+ * Parse arguments of function \a name, opening parenthesis is already parsed
+ */
+bool Expression::parseFunction(const QString &name)
+{
+    qint32 argumentCount = 0;
+    OpCode opCode;
+
+    if (name == "abs")
+    {
+        argumentCount = 1;
+        opCode = OP_ABS;
+    }
+    else if (name == "sqrt")
+    {
+        argumentCount = 1;
+        opCode = OP_SQRT;
+    }
+    else if (name == "log")
+    {
+        argumentCount = 1;
+        opCode = OP_LOG;
+    }
+    else if (name == "exp")
+    {
+        argumentCount = 1;
+        opCode = OP_EXP;
+    }
+    else if (name == "min")
+    {
+        argumentCount = 2;
+        opCode = OP_MIN;
+    }
+    else if (name == "max")
+    {
+        argumentCount = 2;
+        opCode = OP_MAX;
+    }
+    else if (name == "deriv")
+    {
+        argumentCount = 1;
+        opCode = OP_DERIVATIVE;
+    }
+    else if (name == "integ")
+    {
+        argumentCount = 1;
+        opCode = OP_INTEGRAL;
+    }
+    else
+    {
+        return setError(QString("Unknown function: %1").arg(name));
+    }
+
+    for (qint32 argumentIdx = 0; argumentIdx < argumentCount; argumentIdx++)
+    {
+        if ((argumentIdx > 0) && !accept(","))
+        {
+            return setError(QString("%1 expects %2 arguments").arg(name).arg(argumentCount));
+        }
+
+        if (!parseComparison())
+        {
+            return false;
+        }
+    }
+
+    if (!accept(")"))
+    {
+        return setError(QString("Expected ')' at position %1").arg(_pos + 1));
+    }
+
+    if ((opCode == OP_DERIVATIVE) || (opCode == OP_INTEGRAL))
+    {
+        addInstruction(opCode, _stateCount);
+        _stateCount++;
+    }
+    else
+    {
+        addInstruction(opCode);
+    }
+
+    return true;
+}
+
+void Expression::skipWhitespace()
+{
+    while ((_pos < _source.size()) && _source[_pos].isSpace())
+    {
+        _pos++;
+    }
+}
+
+bool Expression::accept(const QString &token)
+{
+    skipWhitespace();
+
+    if (_source.midRef(_pos, token.size()) == token)
+    {
+        _pos += token.size();
+        return true;
+    }
+
+    return false;
+}
+
+void Expression::addInstruction(OpCode opCode, qint32 operand, double constant)
+{
+    Instruction instruction;
+    instruction.opCode = opCode;
+    instruction.operand = operand;
+    instruction.constant = constant;
+
+    _program.append(instruction);
+
+    /* Track size of value stack */
+    switch (opCode)
+    {
+    case OP_CONSTANT:
+    case OP_KEY:
+    case OP_INPUT:
+        _stackDepth++;
+        _maxStackDepth = qMax(_maxStackDepth, _stackDepth);
+        break;
+
+    case OP_ADD:
+    case OP_SUBTRACT:
+    case OP_MULTIPLY:
+    case OP_DIVIDE:
+    case OP_POWER:
+    case OP_LESS:
+    case OP_GREATER:
+    case OP_LESS_EQUAL:
+    case OP_GREATER_EQUAL:
+    case OP_EQUAL:
+    case OP_NOT_EQUAL:
+    case OP_MIN:
+    case OP_MAX:
+        _stackDepth--;
+        break;
+
+    default:
+        break;
+    }
+}
+
+bool Expression::setError(const QString &error)
+{
+    _error = error;
+
+    return false;
+}
+
+/*!
+ * Copy values of \a input, samples after the end of a shorter graph have the value of its placeholder
+ * (GraphDataModel::cPlaceholderValue, drawn as constant line by MyQCPGraph)
+ */
+void Expression::loadInput(double * pDst, const Input &input, qint32 firstIdx, qint32 count)
+{
+    const qint32 availableCount = qBound(0, input.pDataMap->size() - firstIdx, count);
+
+    QCPGraphDataContainer::const_iterator it = input.pDataMap->constBegin() + firstIdx;
+    for (qint32 idx = 0; idx < availableCount; idx++)
+    {
+        pDst[idx] = input.gain * (it + idx)->value + input.offset;
+    }
+
+    std::fill(pDst + availableCount, pDst + count, input.gain * GraphDataModel::cPlaceholderValue + input.offset);
+}
+
+/*!
+ * Derivative (per second) or running integral (value * second), \a pState continues from the previous block
+ * NaN values are skipped
+ */
+void Expression::runState(double * pValues, const double * pKeys, qint32 count, OpCode opCode, State * pState)
+{
+    for (qint32 idx = 0; idx < count; idx++)
+    {
+        const double key = pKeys[idx];
+        const double value = pValues[idx];
+        double result;
+
+        if (opCode == OP_DERIVATIVE)
+        {
+            result = qQNaN();
+            if (pState->bValid && !qIsNaN(value) && (key != pState->key))
+            {
+                result = (value - pState->value) / ((key - pState->key) / 1000);
+            }
+        }
+        else
+        {
+            if (pState->bValid && !qIsNaN(value))
+            {
+                pState->sum += (key - pState->key) * (value + pState->value) / 2 / 1000;
+            }
+            result = pState->sum;
+        }
+
+        if (!qIsNaN(value))
+        {
+            pState->bValid = true;
+            pState->key = key;
+            pState->value = value;
+        }
+
+        pValues[idx] = result;
+    }
+}
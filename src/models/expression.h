@@ -0,0 +1,131 @@
+#ifndef EXPRESSION_H
+#define EXPRESSION_H
+
+#include <QString>
+#include <QStringList>
+#include <QVector>
+#include "qcustomplot.h"
+
+/*
+ * Expression on graph data, evaluated for every sample
+ *
+ * Supported:
+ *  - numbers, arithmetic (+ - * / ^) and comparisons (< > <= >= == !=, result is 1 or 0)
+ *  - t: key of the sample (ms), y: value of the graph the expression is evaluated for
+ *  - [label]: value of the graph with that label
+ *  - abs(x), sqrt(x), log(x), exp(x), min(a, b), max(a, b)
+ *  - deriv(x): change per second, integ(x): running integral (value * second)
+ *
+ * The source is compiled once to a stack based program. The program is run on blocks
+ * of _cBlockSize samples: every instruction processes a complete block in a plain loop,
+ * so the interpretation overhead is shared by all samples of a block and the loops can be
+ * vectorized by the compiler. Only deriv and integ carry state from one sample to the next.
+ *
+ * All graphs share the time axis, so sample n of every referenced graph belongs to key n.
+ * Values of referenced graphs include their gain and offset.
+ * */
+class Expression
+{
+
+public:
+
+    typedef struct
+    {
+        const QCPGraphDataContainer * pDataMap;
+        double gain;
+        double offset;
+
+    } Input;
+
+    static const qint32 cSelfReference; // y
+
+    explicit Expression();
+
+    bool compile(const QString &source, const QStringList &labelList);
+    bool isValid() const;
+    QString source() const;
+    QString errorString() const;
+
+    QList<qint32> references() const;
+
+    void evaluate(const QVector<Input> &inputs, const QCPGraphDataContainer * pKeyMap, qint32 beginIdx, qint32 endIdx, double * pResult) const;
+
+private:
+
+    typedef enum
+    {
+        OP_CONSTANT = 0,
+        OP_KEY,
+        OP_INPUT,
+        OP_NEGATE,
+        OP_ADD,
+        OP_SUBTRACT,
+        OP_MULTIPLY,
+        OP_DIVIDE,
+        OP_POWER,
+        OP_LESS,
+        OP_GREATER,
+        OP_LESS_EQUAL,
+        OP_GREATER_EQUAL,
+        OP_EQUAL,
+        OP_NOT_EQUAL,
+        OP_ABS,
+        OP_SQRT,
+        OP_LOG,
+        OP_EXP,
+        OP_MIN,
+        OP_MAX,
+        OP_DERIVATIVE,
+        OP_INTEGRAL,
+
+    } OpCode;
+
+    typedef struct
+    {
+        OpCode opCode;
+        qint32 operand; // input or state index
+        double constant;
+
+    } Instruction;
+
+    typedef struct
+    {
+        bool bValid;
+        double key;
+        double value;
+        double sum;
+
+    } State;
+
+    bool parseComparison();
+    bool parseAdditive();
+    bool parseTerm();
+    bool parseUnary();
+    bool parsePower();
+    bool parsePrimary();
+    bool parseFunction(const QString &name);
+
+    void skipWhitespace();
+    bool accept(const QString &token);
+    void addInstruction(OpCode opCode, qint32 operand = 0, double constant = 0);
+    bool setError(const QString &error);
+
+    static void loadInput(double * pDst, const Input &input, qint32 firstIdx, qint32 count);
+    static void runState(double * pValues, const double * pKeys, qint32 count, OpCode opCode, State * pState);
+
+    QString _source;
+    qint32 _pos;
+    QString _error;
+    QStringList _labelList;
+
+    QVector<Instruction> _program;
+    QList<qint32> _references; // graph index per input, cSelfReference for y
+    qint32 _stackDepth;
+    qint32 _maxStackDepth;
+    qint32 _stateCount;
+
+    static const qint32 _cBlockSize;
+
+};
+
+#endif // EXPRESSION_H
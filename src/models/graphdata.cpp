@@ -6,12 +6,17 @@ GraphData::GraphData()
     _label = QString("Unknown register");
     _color = "-1"; // Invalid color
     _bActive = true;
+    _gain = 1;
+    _offset = 0;
 
     _pDataMap = QSharedPointer<QCPGraphDataContainer>(new QCPGraphDataContainer);
+    _pDataIndex = QSharedPointer<GraphDataIndex>(new GraphDataIndex(_pDataMap));
 }
 
 GraphData::~GraphData()
 {
+    _pFilter.clear();
+    _pDataIndex.clear();
     _pDataMap.clear();
 }
 
@@ -55,7 +60,72 @@ void GraphData::setActive(bool bActive)
     _bActive = bActive;
 }
 
+double GraphData::gain() const
+{
+    return _gain;
+}
+
+void GraphData::setGain(double gain)
+{
+    _gain = gain;
+}
+
+double GraphData::offset() const
+{
+    return _offset;
+}
+
+void GraphData::setOffset(double offset)
+{
+    _offset = offset;
+}
+
+QString GraphData::expression() const
+{
+    return _expression;
+}
+
+void GraphData::setExpression(const QString &expression)
+{
+    _expression = expression;
+}
+
+bool GraphData::isDerived() const
+{
+    return !_expression.isEmpty();
+}
+
+QString GraphData::derivedError() const
+{
+    return _derivedError;
+}
+
+void GraphData::setDerivedError(const QString &error)
+{
+    _derivedError = error;
+}
+
+QSharedPointer<GraphFilter> GraphData::filter()
+{
+    return _pFilter;
+}
+
+void GraphData::setFilter(QSharedPointer<GraphFilter> pFilter)
+{
+    _pFilter = pFilter;
+}
+
+bool GraphData::isFilter() const
+{
+    return !_pFilter.isNull();
+}
+
 QSharedPointer<QCPGraphDataContainer> GraphData::dataMap()
 {
     return _pDataMap;
 }
+
+QSharedPointer<GraphDataIndex> GraphData::dataIndex()
+{
+    return _pDataIndex;
+}
@@ -3,6 +3,8 @@
 
 #include <QColor>
 #include "qcustomplot.h"
+#include "graphdataindex.h"
+#include "graphfilter.h"
 
 class GraphData
 {
@@ -23,7 +25,25 @@ public:
     bool isActive() const;
     void setActive(bool bActive);
 
+    double gain() const;
+    void setGain(double gain);
+
+    double offset() const;
+    void setOffset(double offset);
+
+    QString expression() const;
+    void setExpression(const QString &expression);
+    bool isDerived() const;
+
+    QString derivedError() const;
+    void setDerivedError(const QString &error);
+
+    QSharedPointer<GraphFilter> filter();
+    void setFilter(QSharedPointer<GraphFilter> pFilter);
+    bool isFilter() const;
+
     QSharedPointer<QCPGraphDataContainer> dataMap();
+    QSharedPointer<GraphDataIndex> dataIndex();
 
 private:
 
@@ -32,7 +52,19 @@ private:
     QColor _color;
     bool _bActive;
 
+    /* Shown value is gain * sample + offset, samples are kept unmodified */
+    double _gain;
+    double _offset;
+
+    /* Derived graphs are calculated from other graphs, empty for graphs with parsed data */
+    QString _expression;
+    QString _derivedError; // error of last calculation, empty when valid
+
+    /* Filter graphs are calculated lazily from a source graph, NULL for other graphs */
+    QSharedPointer<GraphFilter> _pFilter;
+
     QSharedPointer<QCPGraphDataContainer> _pDataMap;
+    QSharedPointer<GraphDataIndex> _pDataIndex;
 
 };
 
@@ -0,0 +1,818 @@
+
+#include <limits>
+#include <algorithm> // std::sort, std::upper_bound
+#include <QtMath>
+
+#include "graphdataindex.h"
+
+GraphDataIndex::GraphDataIndex(QSharedPointer<QCPGraphDataContainer> pDataMap)
+{
+    _pDataMap = pDataMap;
+
+    _indexedCount = 0;
+    _bValid = false;
+    _revision = 0;
+
+    _dirtyBegin = std::numeric_limits<qint32>::max();
+    _dirtyEnd = 0;
+
+    _bSumOffsetValid = false;
+    _sumOffset = 0;
+
+    _keyBounds.min = std::numeric_limits<double>::infinity();
+    _keyBounds.max = -std::numeric_limits<double>::infinity();
+    _valueBounds = _keyBounds;
+}
+
+/*!
+ * Force a complete rebuild of the index on next query.
+ * Should be called when samples are changed instead of appended
+ */
+void GraphDataIndex::invalidate()
+{
+    _bValid = false;
+    _revision++;
+
+    recordChange(0);
+}
+
+/*!
+ * Values of samples [beginIdx, endIdx[ are modified, the keys and the size are unchanged
+ * Only the part of the index that covers these samples is updated on next query
+ */
+void GraphDataIndex::invalidate(qint32 beginIdx, qint32 endIdx)
+{
+    if (beginIdx < endIdx)
+    {
+        _dirtyBegin = qMin(_dirtyBegin, beginIdx);
+        _dirtyEnd = qMax(_dirtyEnd, endIdx);
+        _revision++;
+
+        recordChange(beginIdx);
+    }
+}
+
+/*!
+ * Changes on every invalidate, stays the same while samples are only appended
+ */
+quint32 GraphDataIndex::revision() const
+{
+    return _revision;
+}
+
+/*!
+ * First sample that is modified since revision \a sinceRevision, samples before it are unchanged
+ * Appended samples aren't reported. Returns 0 when the revision is older than the change history
+ * and std::numeric_limits<qint32>::max() when nothing is modified
+ */
+qint32 GraphDataIndex::firstChangedSample(quint32 sinceRevision) const
+{
+    const quint32 changeCount = _revision - sinceRevision;
+
+    if (changeCount > static_cast<quint32>(_changeBegins.size()))
+    {
+        return 0;
+    }
+
+    qint32 firstIdx = std::numeric_limits<qint32>::max();
+    for (qint32 idx = _changeBegins.size() - changeCount; idx < _changeBegins.size(); idx++)
+    {
+        firstIdx = qMin(firstIdx, _changeBegins[idx]);
+    }
+
+    return firstIdx;
+}
+
+/*!
+ * Keep first modified sample of the current revision, only the last _cChangeHistory are kept
+ */
+void GraphDataIndex::recordChange(qint32 beginIdx)
+{
+    if (_changeBegins.size() == _cChangeHistory)
+    {
+        _changeBegins.removeFirst();
+    }
+
+    _changeBegins.append(beginIdx);
+}
+
+/*!
+ * Value range of all samples with a key inside \a keyRange (bounds included)
+ */
+QCPRange GraphDataIndex::valueRange(bool &bFoundRange, const QCPRange &keyRange)
+{
+    const qint32 beginIdx = _pDataMap->findBegin(keyRange.lower, false) - _pDataMap->constBegin();
+    const qint32 endIdx = _pDataMap->findEnd(keyRange.upper, false) - _pDataMap->constBegin();
+
+    return valueRange(bFoundRange, beginIdx, endIdx);
+}
+
+/*!
+ * Value range of samples [beginIdx, endIdx[, NaN values are ignored
+ */
+QCPRange GraphDataIndex::valueRange(bool &bFoundRange, qint32 beginIdx, qint32 endIdx)
+{
+    synchronize();
+
+    MinMax result;
+    result.min = std::numeric_limits<double>::infinity();
+    result.max = -std::numeric_limits<double>::infinity();
+
+    beginIdx = qMax(beginIdx, 0);
+    endIdx = qMin(endIdx, _indexedCount);
+
+    if (beginIdx < endIdx)
+    {
+        const qint32 beginBlock = (beginIdx + _cBlockSize - 1) / _cBlockSize;
+        const qint32 endBlock = endIdx / _cBlockSize;
+
+        if (beginBlock < endBlock)
+        {
+            /* Partial blocks at edges are scanned, full blocks are taken from tree */
+            scanSamples(&result, beginIdx, beginBlock * _cBlockSize);
+            queryBlocks(&result, beginBlock, endBlock);
+            scanSamples(&result, endBlock * _cBlockSize, endIdx);
+        }
+        else
+        {
+            scanSamples(&result, beginIdx, endIdx);
+        }
+    }
+
+    bFoundRange = result.min <= result.max;
+
+    if (bFoundRange)
+    {
+        return QCPRange(result.min, result.max);
+    }
+    else
+    {
+        return QCPRange();
+    }
+}
+
+/*!
+ * Statistics of samples [beginIdx, endIdx[, NaN values are ignored.
+ * The integral only contains segments between samples inside the range
+ */
+GraphDataIndex::Statistics GraphDataIndex::statistics(qint32 beginIdx, qint32 endIdx)
+{
+    synchronize();
+
+    Statistics result;
+    result.count = 0;
+    result.mean = 0;
+    result.variance = 0;
+    result.meanSquare = 0;
+    result.integral = 0;
+
+    beginIdx = qMax(beginIdx, 0);
+    endIdx = qMin(endIdx, _indexedCount);
+
+    if (beginIdx < endIdx)
+    {
+        Sums sums;
+        querySums(&sums, beginIdx, endIdx);
+
+        /* Remove segment between first sample and the one before the range */
+        if (beginIdx > 0)
+        {
+            Sums edge;
+            scanSums(&edge, beginIdx, beginIdx + 1);
+            sums.integral -= edge.integral;
+            sums.integralSpan -= edge.integralSpan;
+        }
+
+        result.integral = sums.integral + _sumOffset * sums.integralSpan;
+        result.count = sums.count;
+
+        if (sums.count > 0)
+        {
+            const double shiftedMean = sums.sum / sums.count;
+
+            result.mean = _sumOffset + shiftedMean;
+            result.variance = qMax(sums.sumSquares / sums.count - shiftedMean * shiftedMean, 0.0);
+            result.meanSquare = result.variance + result.mean * result.mean;
+        }
+    }
+
+    return result;
+}
+
+/*!
+ * Approximate quantile (\a fraction between 0 and 1) of samples [beginIdx, endIdx[,
+ * NaN values are ignored. Exact when the range doesn't contain a full sketch group
+ */
+double GraphDataIndex::quantile(bool &bFound, qint32 beginIdx, qint32 endIdx, double fraction)
+{
+    synchronize();
+
+    beginIdx = qMax(beginIdx, 0);
+    endIdx = qMin(endIdx, _indexedCount);
+
+    const double boundedFraction = qBound(0.0, fraction, 1.0);
+
+    qint32 beginSketch = (beginIdx + _cSketchBlockSize - 1) / _cSketchBlockSize;
+    qint32 endSketch = qMin(endIdx / _cSketchBlockSize, _sketches.size());
+
+    /* Samples outside of full groups are used exactly */
+    QVector<double> edgeValues;
+    if (beginSketch < endSketch)
+    {
+        collectSamples(&edgeValues, beginIdx, beginSketch * _cSketchBlockSize);
+        collectSamples(&edgeValues, endSketch * _cSketchBlockSize, endIdx);
+    }
+    else
+    {
+        beginSketch = 0;
+        endSketch = 0;
+        collectSamples(&edgeValues, beginIdx, endIdx);
+    }
+
+    std::sort(edgeValues.begin(), edgeValues.end());
+
+    qint64 totalCount = edgeValues.size();
+    for (qint32 sketchIdx = beginSketch; sketchIdx < endSketch; sketchIdx++)
+    {
+        totalCount += _sketches[sketchIdx].count;
+    }
+
+    bFound = totalCount > 0;
+
+    if (!bFound)
+    {
+        return 0;
+    }
+
+    if (beginSketch == endSketch)
+    {
+        /* Exact: nearest rank */
+        return edgeValues[static_cast<qint32>(boundedFraction * (edgeValues.size() - 1) + 0.5)];
+    }
+
+    /* Find smallest value with more than targetRank samples below or equal */
+    const double targetRank = boundedFraction * (totalCount - 1);
+
+    bool bRangeFound;
+    const QCPRange range = valueRange(bRangeFound, beginIdx, endIdx);
+
+    double lower = range.lower;
+    double upper = range.upper;
+
+    if (countBelowOrEqual(edgeValues, beginSketch, endSketch, lower) > targetRank)
+    {
+        return lower;
+    }
+
+    /* Bisection ends when interval can't be split anymore */
+    for (qint32 iteration = 0; iteration < _cMaxBisectionSteps; iteration++)
+    {
+        const double middle = lower + (upper - lower) / 2;
+
+        if (
+            (middle <= lower)
+            || (middle >= upper)
+            )
+        {
+            break;
+        }
+
+        if (countBelowOrEqual(edgeValues, beginSketch, endSketch, middle) > targetRank)
+        {
+            upper = middle;
+        }
+        else
+        {
+            lower = middle;
+        }
+    }
+
+    return upper;
+}
+
+/*!
+ * Key range of all samples with a valid value
+ */
+QCPRange GraphDataIndex::keyBounds(bool &bFoundRange)
+{
+    synchronize();
+
+    bFoundRange = _keyBounds.min <= _keyBounds.max;
+
+    if (bFoundRange)
+    {
+        return QCPRange(_keyBounds.min, _keyBounds.max);
+    }
+    else
+    {
+        return QCPRange();
+    }
+}
+
+/*!
+ * Value range of all samples
+ */
+QCPRange GraphDataIndex::valueBounds(bool &bFoundRange)
+{
+    synchronize();
+
+    bFoundRange = _valueBounds.min <= _valueBounds.max;
+
+    if (bFoundRange)
+    {
+        return QCPRange(_valueBounds.min, _valueBounds.max);
+    }
+    else
+    {
+        return QCPRange();
+    }
+}
+
+/*!
+ * Bring index up to date with data container
+ * Nothing is written when the index is already up to date
+ */
+void GraphDataIndex::synchronize()
+{
+    const qint32 count = _pDataMap->size();
+
+    if (
+        (!_bValid)
+        || (count < _indexedCount)
+        )
+    {
+        /* Full rebuild */
+        _levels.clear();
+        _indexedCount = 0;
+        _bValid = true;
+
+        _prefixSums.clear();
+        _sketches.clear();
+        _bSumOffsetValid = false;
+        _sumOffset = 0;
+
+        _keyBounds.min = std::numeric_limits<double>::infinity();
+        _keyBounds.max = -std::numeric_limits<double>::infinity();
+        _valueBounds = _keyBounds;
+    }
+
+    if (_dirtyBegin < _dirtyEnd)
+    {
+        /* Modified samples that are already indexed, new samples are indexed below */
+        if (_dirtyBegin < qMin(_dirtyEnd, _indexedCount))
+        {
+            updateRange(_dirtyBegin, qMin(_dirtyEnd, _indexedCount));
+        }
+
+        _dirtyBegin = std::numeric_limits<qint32>::max();
+        _dirtyEnd = 0;
+    }
+
+    if (count != _indexedCount)
+    {
+        /* Last block could have been partially filled, so restart from that block */
+        const qint32 blockCount = (count + _cBlockSize - 1) / _cBlockSize;
+        updateBlocks(_indexedCount / _cBlockSize, blockCount, count);
+
+        /* Bounds only need the new samples */
+        updateBounds(_indexedCount, count);
+
+        updateSketches();
+
+        _indexedCount = count;
+    }
+}
+
+/*!
+ * Update blocks [firstBlock, endBlock[ of an index that covers \a count samples
+ * Prefix sums of the blocks after endBlock are shifted by the change of the updated blocks
+ */
+void GraphDataIndex::updateBlocks(qint32 firstBlock, qint32 endBlock, qint32 count)
+{
+    const qint32 blockCount = (count + _cBlockSize - 1) / _cBlockSize;
+
+    if (!_bSumOffsetValid)
+    {
+        /* Use first valid value as offset for sums, all samples before it are NaN and have no sums */
+        QCPGraphDataContainer::const_iterator it = _pDataMap->constBegin() + firstBlock * _cBlockSize;
+        const QCPGraphDataContainer::const_iterator endIt = _pDataMap->constBegin() + qMin(count, endBlock * _cBlockSize);
+        for (; it != endIt; it++)
+        {
+            if (!qIsNaN(it->value))
+            {
+                _sumOffset = it->value;
+                _bSumOffsetValid = true;
+                break;
+            }
+        }
+    }
+
+    if (_levels.isEmpty())
+    {
+        _levels.append(QVector<MinMax>());
+    }
+
+    _levels[0].resize(blockCount);
+
+    for (qint32 blockIdx = firstBlock; blockIdx < endBlock; blockIdx++)
+    {
+        MinMax block;
+        block.min = std::numeric_limits<double>::infinity();
+        block.max = -std::numeric_limits<double>::infinity();
+
+        scanSamples(&block, blockIdx * _cBlockSize, qMin(count, (blockIdx + 1) * _cBlockSize));
+
+        _levels[0][blockIdx] = block;
+    }
+
+    /* Prefix sums, entry of first block is still valid */
+    if (_prefixSums.isEmpty())
+    {
+        Sums start;
+        clearSums(&start);
+        _prefixSums.append(start);
+    }
+
+    _prefixSums.resize(blockCount + 1);
+
+    const Sums previousEnd = _prefixSums[endBlock];
+
+    for (qint32 blockIdx = firstBlock; blockIdx < endBlock; blockIdx++)
+    {
+        Sums blockSums;
+        scanSums(&blockSums, blockIdx * _cBlockSize, qMin(count, (blockIdx + 1) * _cBlockSize));
+
+        Sums prefix = _prefixSums[blockIdx];
+        prefix.count += blockSums.count;
+        prefix.sum += blockSums.sum;
+        prefix.sumSquares += blockSums.sumSquares;
+        prefix.integral += blockSums.integral;
+        prefix.integralSpan += blockSums.integralSpan;
+
+        _prefixSums[blockIdx + 1] = prefix;
+    }
+
+    if (endBlock < blockCount)
+    {
+        Sums delta;
+        delta.count = _prefixSums[endBlock].count - previousEnd.count;
+        delta.sum = _prefixSums[endBlock].sum - previousEnd.sum;
+        delta.sumSquares = _prefixSums[endBlock].sumSquares - previousEnd.sumSquares;
+        delta.integral = _prefixSums[endBlock].integral - previousEnd.integral;
+        delta.integralSpan = _prefixSums[endBlock].integralSpan - previousEnd.integralSpan;
+
+        for (qint32 blockIdx = endBlock + 1; blockIdx <= blockCount; blockIdx++)
+        {
+            _prefixSums[blockIdx].count += delta.count;
+            _prefixSums[blockIdx].sum += delta.sum;
+            _prefixSums[blockIdx].sumSquares += delta.sumSquares;
+            _prefixSums[blockIdx].integral += delta.integral;
+            _prefixSums[blockIdx].integralSpan += delta.integralSpan;
+        }
+    }
+
+    updateLevels(firstBlock, endBlock);
+}
+
+/*!
+ * Update tree nodes above blocks [firstNode, endNode[
+ */
+void GraphDataIndex::updateLevels(qint32 firstNode, qint32 endNode)
+{
+    qint32 level = 0;
+    qint32 dirtyNode = firstNode;
+    qint32 dirtyEnd = endNode;
+
+    while (_levels[level].size() > 1)
+    {
+        const qint32 childCount = _levels[level].size();
+        const qint32 parentCount = (childCount + 1) / 2;
+
+        if (_levels.size() <= level + 1)
+        {
+            _levels.append(QVector<MinMax>());
+        }
+
+        _levels[level + 1].resize(parentCount);
+
+        /* Only parents of changed nodes need an update */
+        const qint32 parentEnd = qMin((dirtyEnd + 1) / 2, parentCount);
+        for (qint32 nodeIdx = dirtyNode / 2; nodeIdx < parentEnd; nodeIdx++)
+        {
+            MinMax node = _levels[level][2 * nodeIdx];
+
+            if ((2 * nodeIdx + 1) < childCount)
+            {
+                combine(&node, _levels[level][2 * nodeIdx + 1]);
+            }
+
+            _levels[level + 1][nodeIdx] = node;
+        }
+
+        dirtyNode /= 2;
+        dirtyEnd = parentEnd;
+        level++;
+    }
+}
+
+void GraphDataIndex::updateBounds(qint32 beginIdx, qint32 endIdx)
+{
+    QCPGraphDataContainer::const_iterator it = _pDataMap->constBegin() + beginIdx;
+    const QCPGraphDataContainer::const_iterator endIt = _pDataMap->constBegin() + endIdx;
+
+    for (; it != endIt; it++)
+    {
+        if (!qIsNaN(it->value))
+        {
+            /* Container is sorted on key */
+            if (_keyBounds.min > _keyBounds.max)
+            {
+                _keyBounds.min = it->key;
+            }
+            _keyBounds.max = it->key;
+
+            if (it->value < _valueBounds.min)
+            {
+                _valueBounds.min = it->value;
+            }
+
+            if (it->value > _valueBounds.max)
+            {
+                _valueBounds.max = it->value;
+            }
+        }
+    }
+}
+
+/*!
+ * Update index after the values of indexed samples [beginIdx, endIdx[ have been modified
+ */
+void GraphDataIndex::updateRange(qint32 beginIdx, qint32 endIdx)
+{
+    /* Segment towards the next sample is part of the integral of that sample */
+    const qint32 sumEndIdx = qMin(endIdx + 1, _indexedCount);
+
+    updateBlocks(beginIdx / _cBlockSize, (sumEndIdx + _cBlockSize - 1) / _cBlockSize, _indexedCount);
+
+    const qint32 endSketch = qMin((endIdx + _cSketchBlockSize - 1) / _cSketchBlockSize, _sketches.size());
+    for (qint32 sketchIdx = beginIdx / _cSketchBlockSize; sketchIdx < endSketch; sketchIdx++)
+    {
+        _sketches[sketchIdx] = calculateSketch(sketchIdx);
+    }
+
+    recalculateBounds();
+}
+
+/*!
+ * Bounds of all indexed samples, taken from the tree instead of scanning every sample
+ */
+void GraphDataIndex::recalculateBounds()
+{
+    const QVector<MinMax> &blocks = _levels[0];
+
+    _valueBounds = _levels.last()[0];
+
+    _keyBounds.min = std::numeric_limits<double>::infinity();
+    _keyBounds.max = -std::numeric_limits<double>::infinity();
+
+    /* Only the first and last block with a valid value are scanned */
+    qint32 firstBlock = 0;
+    while ((firstBlock < blocks.size()) && (blocks[firstBlock].min > blocks[firstBlock].max))
+    {
+        firstBlock++;
+    }
+
+    if (firstBlock < blocks.size())
+    {
+        qint32 lastBlock = blocks.size() - 1;
+        while (blocks[lastBlock].min > blocks[lastBlock].max)
+        {
+            lastBlock--;
+        }
+
+        for (qint32 idx = firstBlock * _cBlockSize; idx < _indexedCount; idx++)
+        {
+            if (!qIsNaN(_pDataMap->at(idx)->value))
+            {
+                _keyBounds.min = _pDataMap->at(idx)->key;
+                break;
+            }
+        }
+
+        for (qint32 idx = qMin((lastBlock + 1) * _cBlockSize, _indexedCount) - 1; idx >= 0; idx--)
+        {
+            if (!qIsNaN(_pDataMap->at(idx)->value))
+            {
+                _keyBounds.max = _pDataMap->at(idx)->key;
+                break;
+            }
+        }
+    }
+}
+
+void GraphDataIndex::updateSketches()
+{
+    const qint32 sketchCount = _pDataMap->size() / _cSketchBlockSize;
+
+    /* Only completed groups are summarized */
+    for (qint32 sketchIdx = _sketches.size(); sketchIdx < sketchCount; sketchIdx++)
+    {
+        _sketches.append(calculateSketch(sketchIdx));
+    }
+}
+
+GraphDataIndex::Sketch GraphDataIndex::calculateSketch(qint32 sketchIdx) const
+{
+    QVector<double> values;
+    values.reserve(_cSketchBlockSize);
+
+    collectSamples(&values, sketchIdx * _cSketchBlockSize, (sketchIdx + 1) * _cSketchBlockSize);
+
+    std::sort(values.begin(), values.end());
+
+    Sketch sketch;
+    sketch.count = values.size();
+
+    if (values.size() <= _cSketchSize)
+    {
+        sketch.items = values;
+    }
+    else
+    {
+        /* Take order statistic in the middle of every equally weighted part */
+        sketch.items.reserve(_cSketchSize);
+        for (qint32 itemIdx = 0; itemIdx < _cSketchSize; itemIdx++)
+        {
+            const qint32 rank = static_cast<qint32>((2 * itemIdx + 1) * static_cast<qint64>(values.size()) / (2 * _cSketchSize));
+            sketch.items.append(values[rank]);
+        }
+    }
+
+    return sketch;
+}
+
+void GraphDataIndex::collectSamples(QVector<double> * pValues, qint32 beginIdx, qint32 endIdx) const
+{
+    QCPGraphDataContainer::const_iterator it = _pDataMap->constBegin() + beginIdx;
+    const QCPGraphDataContainer::const_iterator endIt = _pDataMap->constBegin() + endIdx;
+
+    for (; it != endIt; it++)
+    {
+        if (!qIsNaN(it->value))
+        {
+            pValues->append(it->value);
+        }
+    }
+}
+
+double GraphDataIndex::countBelowOrEqual(const QVector<double> &edgeValues, qint32 beginSketch, qint32 endSketch, double value) const
+{
+    double count = std::upper_bound(edgeValues.constBegin(), edgeValues.constEnd(), value) - edgeValues.constBegin();
+
+    for (qint32 sketchIdx = beginSketch; sketchIdx < endSketch; sketchIdx++)
+    {
+        const Sketch &sketch = _sketches[sketchIdx];
+
+        if (!sketch.items.isEmpty())
+        {
+            const qint32 itemCount = std::upper_bound(sketch.items.constBegin(), sketch.items.constEnd(), value) - sketch.items.constBegin();
+
+            count += static_cast<double>(itemCount) * sketch.count / sketch.items.size();
+        }
+    }
+
+    return count;
+}
+
+void GraphDataIndex::scanSamples(MinMax * pResult, qint32 beginIdx, qint32 endIdx) const
+{
+    QCPGraphDataContainer::const_iterator it = _pDataMap->constBegin() + beginIdx;
+    const QCPGraphDataContainer::const_iterator endIt = _pDataMap->constBegin() + endIdx;
+
+    for (; it != endIt; it++)
+    {
+        const double value = it->value;
+
+        if (!qIsNaN(value))
+        {
+            if (value < pResult->min)
+            {
+                pResult->min = value;
+            }
+
+            if (value > pResult->max)
+            {
+                pResult->max = value;
+            }
+        }
+    }
+}
+
+void GraphDataIndex::queryBlocks(MinMax * pResult, qint32 beginBlock, qint32 endBlock) const
+{
+    qint32 left = beginBlock;
+    qint32 right = endBlock;
+
+    /* Bottom-up walk: combine nodes that aren't fully covered by their parent */
+    for (qint32 level = 0; (left < right) && (level < _levels.size()); level++)
+    {
+        if (left & 1)
+        {
+            combine(pResult, _levels[level][left]);
+            left++;
+        }
+
+        if (right & 1)
+        {
+            right--;
+            combine(pResult, _levels[level][right]);
+        }
+
+        left >>= 1;
+        right >>= 1;
+    }
+}
+
+void GraphDataIndex::scanSums(Sums * pResult, qint32 beginIdx, qint32 endIdx) const
+{
+    clearSums(pResult);
+
+    QCPGraphDataContainer::const_iterator it = _pDataMap->constBegin() + beginIdx;
+    const QCPGraphDataContainer::const_iterator endIt = _pDataMap->constBegin() + endIdx;
+
+    for (; it != endIt; it++)
+    {
+        if (!qIsNaN(it->value))
+        {
+            const double shiftedValue = it->value - _sumOffset;
+
+            pResult->count++;
+            pResult->sum += shiftedValue;
+            pResult->sumSquares += shiftedValue * shiftedValue;
+
+            /* Segment towards previous sample belongs to this sample */
+            if (it != _pDataMap->constBegin())
+            {
+                const QCPGraphDataContainer::const_iterator previousIt = it - 1;
+
+                if (!qIsNaN(previousIt->value))
+                {
+                    const double step = it->key - previousIt->key;
+
+                    pResult->integral += step * (shiftedValue + (previousIt->value - _sumOffset)) / 2;
+                    pResult->integralSpan += step;
+                }
+            }
+        }
+    }
+}
+
+void GraphDataIndex::querySums(Sums * pResult, qint32 beginIdx, qint32 endIdx) const
+{
+    const qint32 beginBlock = (beginIdx + _cBlockSize - 1) / _cBlockSize;
+    const qint32 endBlock = endIdx / _cBlockSize;
+
+    if (beginBlock < endBlock)
+    {
+        Sums leftEdge;
+        Sums rightEdge;
+
+        scanSums(&leftEdge, beginIdx, beginBlock * _cBlockSize);
+        scanSums(&rightEdge, endBlock * _cBlockSize, endIdx);
+
+        const Sums &prefixBegin = _prefixSums[beginBlock];
+        const Sums &prefixEnd = _prefixSums[endBlock];
+
+        pResult->count = prefixEnd.count - prefixBegin.count + leftEdge.count + rightEdge.count;
+        pResult->sum = prefixEnd.sum - prefixBegin.sum + leftEdge.sum + rightEdge.sum;
+        pResult->sumSquares = prefixEnd.sumSquares - prefixBegin.sumSquares + leftEdge.sumSquares + rightEdge.sumSquares;
+        pResult->integral = prefixEnd.integral - prefixBegin.integral + leftEdge.integral + rightEdge.integral;
+        pResult->integralSpan = prefixEnd.integralSpan - prefixBegin.integralSpan + leftEdge.integralSpan + rightEdge.integralSpan;
+    }
+    else
+    {
+        scanSums(pResult, beginIdx, endIdx);
+    }
+}
+
+void GraphDataIndex::combine(MinMax * pResult, const MinMax &other)
+{
+    if (other.min < pResult->min)
+    {
+        pResult->min = other.min;
+    }
+
+    if (other.max > pResult->max)
+    {
+        pResult->max = other.max;
+    }
+}
+
+void GraphDataIndex::clearSums(Sums * pSums)
+{
+    pSums->count = 0;
+    pSums->sum = 0;
+    pSums->sumSquares = 0;
+    pSums->integral = 0;
+    pSums->integralSpan = 0;
+}
@@ -0,0 +1,154 @@
+#ifndef GRAPHDATAINDEX_H
+#define GRAPHDATAINDEX_H
+
+#include <QVector>
+#include "qcustomplot.h"
+
+/*
+ * Range query index on the values of a graph data container
+ *
+ * Samples are grouped in blocks of _cBlockSize points. The minimum and maximum
+ * of every block are stored in the lowest level of a segment tree, every next
+ * level combines two nodes of the level below. The value range of any index range
+ * is found by scanning the (partial) edge blocks and combining O(log n) tree nodes.
+ *
+ * For statistics, prefix sums (count, sum, sum of squares and integral) at every block
+ * boundary are stored. Sums are taken relative to the first valid value of the graph to
+ * limit the loss of precision when two large prefix sums are subtracted. For the integral,
+ * the key span of the integrated segments is summed as well, to add the offset back.
+ *
+ * Percentiles are answered approximately from quantile sketches: every full group of
+ * _cSketchBlockSize samples is summarized by _cSketchSize evenly spaced order statistics.
+ * Sketches are mergeable, a quantile over any range is found by bisection on the value,
+ * counting the weighted sketch items of full groups and the exact samples at the edges.
+ * The rank error is at most 1 / (2 * _cSketchSize) of the samples in the range.
+ *
+ * Running bounds of keys and values of the complete container are kept as well,
+ * so the full data range is available in constant time.
+ *
+ * The index follows the container lazily: appended samples are indexed on the next query.
+ * When existing samples are modified or replaced, invalidate() should be called. When only the
+ * values of a range of samples are modified, invalidate(beginIdx, endIdx) only updates the
+ * blocks, tree nodes and sketches of that range. Every invalidate increments the revision,
+ * so users can tell appended data from changed data. The first modified sample of the last
+ * _cChangeHistory invalidates is kept, so users can only update what changed since their revision.
+ * Every query calls synchronize() first, which only writes to the index when the container has
+ * changed since the last synchronize(). So once synchronize() has been called, queries can be run
+ * from several threads as long as the container isn't modified in the meantime.
+ * */
+class GraphDataIndex
+{
+
+public:
+
+    typedef struct
+    {
+        qint64 count;
+        double mean;
+        double variance;
+        double meanSquare;
+        double integral; // trapezoidal, in value * key unit
+
+    } Statistics;
+
+    explicit GraphDataIndex(QSharedPointer<QCPGraphDataContainer> pDataMap);
+
+    void invalidate();
+    void invalidate(qint32 beginIdx, qint32 endIdx);
+    void synchronize();
+    quint32 revision() const;
+    qint32 firstChangedSample(quint32 sinceRevision) const;
+
+    QCPRange valueRange(bool &bFoundRange, const QCPRange &keyRange);
+    QCPRange valueRange(bool &bFoundRange, qint32 beginIdx, qint32 endIdx);
+
+    Statistics statistics(qint32 beginIdx, qint32 endIdx);
+    double quantile(bool &bFound, qint32 beginIdx, qint32 endIdx, double fraction);
+
+    QCPRange keyBounds(bool &bFoundRange);
+    QCPRange valueBounds(bool &bFoundRange);
+
+private:
+
+    typedef struct
+    {
+        double min;
+        double max;
+
+    } MinMax;
+
+    typedef struct
+    {
+        qint64 count;
+        double sum;
+        double sumSquares;
+        double integral; // relative to _sumOffset
+        double integralSpan; // sum of key steps of integrated segments
+
+    } Sums;
+
+    typedef struct
+    {
+        qint64 count;
+        QVector<double> items; // sorted
+
+    } Sketch;
+
+    void recordChange(qint32 beginIdx);
+    void updateBlocks(qint32 firstBlock, qint32 endBlock, qint32 count);
+    void updateLevels(qint32 firstNode, qint32 endNode);
+    void updateBounds(qint32 beginIdx, qint32 endIdx);
+    void updateRange(qint32 beginIdx, qint32 endIdx);
+    void recalculateBounds();
+    void updateSketches();
+    Sketch calculateSketch(qint32 sketchIdx) const;
+
+    void scanSamples(MinMax * pResult, qint32 beginIdx, qint32 endIdx) const;
+    void queryBlocks(MinMax * pResult, qint32 beginBlock, qint32 endBlock) const;
+
+    void scanSums(Sums * pResult, qint32 beginIdx, qint32 endIdx) const;
+    void querySums(Sums * pResult, qint32 beginIdx, qint32 endIdx) const;
+
+    void collectSamples(QVector<double> * pValues, qint32 beginIdx, qint32 endIdx) const;
+    double countBelowOrEqual(const QVector<double> &edgeValues, qint32 beginSketch, qint32 endSketch, double value) const;
+
+    static void combine(MinMax * pResult, const MinMax &other);
+    static void clearSums(Sums * pSums);
+
+    QSharedPointer<QCPGraphDataContainer> _pDataMap;
+
+    qint32 _indexedCount;
+    bool _bValid;
+    quint32 _revision;
+
+    /* Modified samples [_dirtyBegin, _dirtyEnd[ that are already indexed, empty when begin >= end */
+    qint32 _dirtyBegin;
+    qint32 _dirtyEnd;
+
+    /* First modified sample per invalidate, last one is of the current revision */
+    QVector<qint32> _changeBegins;
+
+    /* _levels[0] contains block results, last level contains the root */
+    QVector<QVector<MinMax> > _levels;
+
+    /* _prefixSums[n] contains sums of samples before block n */
+    QVector<Sums> _prefixSums;
+    double _sumOffset;
+    bool _bSumOffsetValid;
+
+    /* _sketches[n] summarizes samples of group n */
+    QVector<Sketch> _sketches;
+
+    /* Bounds of samples with a valid (non-NaN) value */
+    MinMax _keyBounds;
+    MinMax _valueBounds;
+
+    static const qint32 _cBlockSize = 64;
+    static const qint32 _cSketchBlockSize = 4096;
+    static const qint32 _cSketchSize = 64;
+    static const qint32 _cMaxBisectionSteps = 100;
+    static const qint32 _cChangeHistory = 16;
+
+};
+
+#endif // GRAPHDATAINDEX_H
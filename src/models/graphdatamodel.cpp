@@ -1,16 +1,31 @@
 
 #include <QMessageBox>
+#include <QElapsedTimer>
 #include "graphdata.h"
 #include "util.h"
 #include "QDebug"
+#include "expression.h"
 
 #include "graphdatamodel.h"
 
+const double GraphDataModel::cPlaceholderValue = 0;
 
 GraphDataModel::GraphDataModel(QObject *parent) : QAbstractTableModel(parent)
 {
     _graphData.clear();
 
+    _updateDepth = 0;
+    _bActiveListDirty = false;
+    _bGraphListChanged = false;
+    _bGraphPropertiesChanged = false;
+
+    _filterKeyRange = QCPRange(-QCPRange::maxRange, QCPRange::maxRange);
+
+    /* Remaining filter chunks are calculated in steps, so the GUI stays responsive */
+    _filterTimer.setSingleShot(true);
+    _filterTimer.setInterval(0);
+    connect(&_filterTimer, SIGNAL(timeout()), this, SLOT(calculateFilterTimeout()));
+
     connect(this, SIGNAL(visibilityChanged(quint32)), this, SLOT(modelDataChanged(quint32)));
     connect(this, SIGNAL(labelChanged(quint32)), this, SLOT(modelDataChanged(quint32)));
     connect(this, SIGNAL(colorChanged(quint32)), this, SLOT(modelDataChanged(quint32)));
@@ -18,6 +33,8 @@ GraphDataModel::GraphDataModel(QObject *parent) : QAbstractTableModel(parent)
 
     connect(this, SIGNAL(added(quint32)), this, SLOT(modelDataChanged()));
     connect(this, SIGNAL(removed(quint32)), this, SLOT(modelDataChanged()));
+    connect(this, SIGNAL(graphListChanged()), this, SLOT(modelDataChanged()));
+    connect(this, SIGNAL(graphPropertiesChanged()), this, SLOT(modelDataChanged()));
 }
 
 int GraphDataModel::rowCount(const QModelIndex & /*parent*/) const
@@ -233,17 +250,86 @@ bool GraphDataModel::isActive(quint32 index) const
     return _graphData[index].isActive();
 }
 
+double GraphDataModel::gain(quint32 index) const
+{
+    return _graphData[index].gain();
+}
+
+double GraphDataModel::offset(quint32 index) const
+{
+    return _graphData[index].offset();
+}
+
+bool GraphDataModel::isDerived(quint32 index) const
+{
+    return _graphData[index].isDerived();
+}
+
+QString GraphDataModel::expression(quint32 index) const
+{
+    return _graphData[index].expression();
+}
+
+/*!
+ * Error of last calculation of derived graph, empty when the graph is valid
+ */
+QString GraphDataModel::derivedError(quint32 index) const
+{
+    return _graphData[index].derivedError();
+}
+
+bool GraphDataModel::isFilter(quint32 index) const
+{
+    return _graphData[index].isFilter();
+}
+
 QSharedPointer<QCPGraphDataContainer> GraphDataModel::dataMap(quint32 index)
 {
     return _graphData[index].dataMap();
 }
 
+/*!
+ * Data of graph \a index with every sample in \a keyRange, for analysis that reads all samples of a range
+ * Filter graphs are only calculated for the filter key range, missing samples in \a keyRange are calculated first
+ */
+QSharedPointer<QCPGraphDataContainer> GraphDataModel::dataMap(quint32 index, const QCPRange &keyRange)
+{
+    if (hasPendingFilterChunks(index, keyRange))
+    {
+        QWriteLocker locker(&_dataLock);
+        completeFilter(index, keyRange);
+        locker.unlock();
+
+        emit filterDataChanged();
+    }
+
+    return _graphData[index].dataMap();
+}
+
+QSharedPointer<GraphDataIndex> GraphDataModel::dataIndex(quint32 index)
+{
+    return _graphData[index].dataIndex();
+}
+
+/*!
+ * Lock that protects the data containers against modification while they are read from another thread
+ * Data containers are only modified by the GUI thread, so the GUI thread doesn't need to lock for reading
+ */
+QReadWriteLock * GraphDataModel::dataLock()
+{
+    return &_dataLock;
+}
+
 void GraphDataModel::setVisible(quint32 index, bool bVisible)
 {
     if (_graphData[index].isVisible() != bVisible)
     {
-         _graphData[index].setVisible(bVisible);
-         emit visibilityChanged(index);
+        _graphData[index].setVisible(bVisible);
+
+        if (!recordBatchChange(false))
+        {
+            emit visibilityChanged(index);
+        }
     }
 }
 
@@ -251,8 +337,12 @@ void GraphDataModel::setLabel(quint32 index, const QString &label)
 {
     if (_graphData[index].label() != label)
     {
-         _graphData[index].setLabel(label);
-         emit labelChanged(index);
+        _graphData[index].setLabel(label);
+
+        if (!recordBatchChange(false))
+        {
+            emit labelChanged(index);
+        }
     }
 }
 
@@ -260,8 +350,12 @@ void GraphDataModel::setColor(quint32 index, const QColor &color)
 {
     if (_graphData[index].color() != color)
     {
-         _graphData[index].setColor(color);
-         emit colorChanged(index);
+        _graphData[index].setColor(color);
+
+        if (!recordBatchChange(false))
+        {
+            emit colorChanged(index);
+        }
     }
 }
 
@@ -277,31 +371,126 @@ void GraphDataModel::setActive(quint32 index, bool bActive)
         // When deactivated, clear data
         if (!bActive)
         {
+            QWriteLocker locker(&_dataLock);
             _graphData[index].dataMap()->clear();
+            _graphData[index].dataIndex()->invalidate();
+            locker.unlock();
+
+            // Filters of this graph are cleared as well
+            updateFilterGraphs();
         }
         else
         {
             // when (re)-added, make sure graph is always visible
             _graphData[index].setVisible(true);
+
+            if (_graphData[index].isDerived())
+            {
+                recalculateDerived(index);
+            }
+            else if (_graphData[index].isFilter())
+            {
+                QWriteLocker locker(&_dataLock);
+                synchronizeFilter(index);
+                locker.unlock();
+
+                _filterTimer.start();
+            }
         }
 
-        emit activeChanged(index);
+        if (!recordBatchChange(true))
+        {
+            emit activeChanged(index);
+        }
     }
 }
 
-void GraphDataModel::add(GraphData rowData)
+/*!
+ * Shown value of the graph becomes gain * sample + offset
+ * The samples aren't modified, so only a replot is needed
+ */
+void GraphDataModel::setScaling(quint32 index, double gain, double offset)
 {
-    addToModel(&rowData);
+    if (
+        (_graphData[index].gain() != gain)
+        || (_graphData[index].offset() != offset)
+        )
+    {
+        _graphData[index].setGain(gain);
+        _graphData[index].setOffset(offset);
+
+        if (!recordBatchChange(false))
+        {
+            emit scalingChanged(index);
+        }
+
+        // Filters use the scaled values of their source
+        if (updateFilterGraphs())
+        {
+            emit filterDataChanged();
+        }
+    }
 }
 
-void GraphDataModel::add(QList<GraphData> graphDataList)
+/*!
+ * Start a batch of changes
+ * Until the matching endUpdate, no signals are emitted for single graphs
+ * and the active graph list isn't updated
+ */
+void GraphDataModel::beginUpdate()
 {
-    for (qint32 idx = 0; idx < graphDataList.size(); idx++)
+    _updateDepth++;
+}
+
+/*!
+ * End a batch of changes
+ * Emits a single graphListChanged or graphPropertiesChanged for all changes in the batch
+ */
+void GraphDataModel::endUpdate()
+{
+    if (_updateDepth > 0)
+    {
+        _updateDepth--;
+    }
+
+    if (_updateDepth == 0)
     {
-        add(graphDataList[idx]);
+        if (_bActiveListDirty)
+        {
+            updateActiveGraphList();
+        }
+
+        const bool bGraphListChanged = _bGraphListChanged;
+        const bool bGraphPropertiesChanged = _bGraphPropertiesChanged;
+
+        _bGraphListChanged = false;
+        _bGraphPropertiesChanged = false;
+
+        if (bGraphListChanged)
+        {
+            /* Consumers rebuild their lists, this includes the properties */
+            emit graphListChanged();
+        }
+        else if (bGraphPropertiesChanged)
+        {
+            emit graphPropertiesChanged();
+        }
     }
 }
 
+void GraphDataModel::add(GraphData rowData)
+{
+    addToModel(QList<GraphData>() << rowData);
+}
+
+/*!
+ * Add all graphs at once with a single notification
+ */
+void GraphDataModel::add(QList<GraphData> graphDataList)
+{
+    addToModel(graphDataList);
+}
+
 void GraphDataModel::add()
 {
     GraphData data;
@@ -313,15 +502,147 @@ void GraphDataModel::add()
 
 void GraphDataModel::add(QList<QString> labelList, QList<double> timeData, QList<QList<double> > data)
 {
+    QList<GraphData> graphDataList;
+    graphDataList.reserve(labelList.size());
+
     foreach(QString label, labelList)
     {
-        add();
-        setLabel(_graphData.size() - 1, label);
+        GraphData graphData;
+        graphData.setLabel(label);
+
+        graphDataList.append(graphData);
     }
 
+    add(graphDataList);
+
     emit graphsAddData(timeData, data);
 }
 
+/*!
+ * Add graph that is calculated from other graphs with \a expression (see Expression)
+ * Returns false and sets \a pError when the expression isn't valid
+ */
+bool GraphDataModel::addDerived(const QString &label, const QString &expression, QString * pError)
+{
+    GraphData graphData;
+    graphData.setLabel(label);
+    graphData.setExpression(expression);
+
+    _graphData.append(graphData);
+    const bool bOk = calculateDerived(_graphData.size() - 1, pError);
+    _graphData.removeLast();
+
+    if (bOk)
+    {
+        add(graphData);
+    }
+
+    return bOk;
+}
+
+/*!
+ * Calculate all active derived graphs again, called after data of the parsed graphs has changed
+ * Returns true when at least one graph is updated
+ */
+bool GraphDataModel::updateDerivedGraphs()
+{
+    bool bUpdated = false;
+
+    for (qint32 idx = 0; idx < _graphData.size(); idx++)
+    {
+        if (_graphData[idx].isDerived() && _graphData[idx].isActive())
+        {
+            recalculateDerived(idx);
+            bUpdated = true;
+        }
+    }
+
+    return bUpdated;
+}
+
+/*!
+ * Add graph that filters graph \a sourceIdx (see GraphFilter)
+ * Only the keys are copied now, the filter is calculated for the visible range when needed
+ */
+bool GraphDataModel::addFilter(quint32 sourceIdx, GraphFilter::FilterType type, qint32 length)
+{
+    if (
+        (sourceIdx >= (quint32)_graphData.size())
+        || _graphData[sourceIdx].isFilter()
+        )
+    {
+        /* Filters aren't calculated for the full range, so they can't be filtered */
+        return false;
+    }
+
+    QSharedPointer<GraphFilter> pFilter = QSharedPointer<GraphFilter>(new GraphFilter(type, length, sourceIdx));
+
+    GraphData graphData;
+    graphData.setLabel(QString("%1 (%2)").arg(_graphData[sourceIdx].label()).arg(pFilter->description()));
+    graphData.setFilter(pFilter);
+
+    qint32 modifiedBegin;
+    QWriteLocker locker(&_dataLock);
+    pFilter->synchronize(_graphData[sourceIdx].dataMap().data(),
+                         _graphData[sourceIdx].dataIndex().data(),
+                         _graphData[sourceIdx].gain(),
+                         _graphData[sourceIdx].offset(),
+                         graphData.dataMap().data(),
+                         &modifiedBegin);
+    locker.unlock();
+
+    add(graphData);
+
+    _filterTimer.start();
+
+    return true;
+}
+
+/*!
+ * Follow data changes of the sources of all active filter graphs
+ * Appended samples are calculated immediately, other changes are calculated again for the visible range
+ * Returns true when at least one graph is updated
+ */
+bool GraphDataModel::updateFilterGraphs()
+{
+    bool bUpdated = false;
+
+    QWriteLocker locker(&_dataLock);
+
+    for (qint32 idx = 0; idx < _graphData.size(); idx++)
+    {
+        if (_graphData[idx].isFilter() && _graphData[idx].isActive())
+        {
+            if (synchronizeFilter(idx))
+            {
+                bUpdated = true;
+            }
+        }
+    }
+
+    locker.unlock();
+
+    if (calculateFilterChunks())
+    {
+        bUpdated = true;
+    }
+
+    return bUpdated;
+}
+
+/*!
+ * Set visible key range, filter graphs are calculated for this range with a margin on both sides
+ * Returns true when filter data is calculated, the rest is calculated in the background (see filterDataChanged)
+ */
+bool GraphDataModel::setFilterKeyRange(const QCPRange &keyRange)
+{
+    const double margin = keyRange.size() / 2;
+
+    _filterKeyRange = QCPRange(keyRange.lower - margin, keyRange.upper + margin);
+
+    return calculateFilterChunks();
+}
+
 void GraphDataModel::removeRegister(qint32 idx)
 {   
     if (idx < _graphData.size())
@@ -332,11 +653,22 @@ void GraphDataModel::removeRegister(qint32 idx)
 
 void GraphDataModel::clear()
 {
-    const qint32 size = _graphData.size();
+    if (_graphData.isEmpty())
+    {
+        return;
+    }
+
+    beginResetModel();
+
+    _graphData.clear();
+
+    updateActiveGraphList();
 
-    for(qint32 idx = 0; idx < size; idx++)
+    endResetModel();
+
+    if (!recordBatchChange(true))
     {
-        removeRegister(0);
+        emit graphListChanged();
     }
 }
 
@@ -345,28 +677,23 @@ void GraphDataModel::activeGraphIndexList(QList<quint16> * pList)
 {
     // Clear list
     pList->clear();
+    pList->reserve(_activeGraphList.size());
 
+    // _activeGraphList is already sorted
     foreach(quint32 idx, _activeGraphList)
     {
         pList->append(idx);
     }
-
-    // sort qList
-    qSort(*pList);
 }
 
 qint32 GraphDataModel::convertToActiveGraphIndex(quint32 graphIdx)
 {
-    qint16 result = -1;
-    for (qint32 activeIdx = 0; activeIdx < _activeGraphList.size(); activeIdx++)
+    if (graphIdx < (quint32)_activeIndexOfGraph.size())
     {
-        if (_activeGraphList[activeIdx] == graphIdx)
-        {
-            result = activeIdx;
-            break;
-        }
+        return _activeIndexOfGraph[graphIdx];
     }
-    return result;
+
+    return -1;
 }
 
 qint32 GraphDataModel::convertToGraphIndex(quint32 activeIdx)
@@ -376,13 +703,24 @@ qint32 GraphDataModel::convertToGraphIndex(quint32 activeIdx)
 
 void GraphDataModel::updateActiveGraphList(void)
 {
+    if (_updateDepth > 0)
+    {
+        /* Rebuild once at end of batch */
+        _bActiveListDirty = true;
+        return;
+    }
+
+    _bActiveListDirty = false;
+
     // Clear list
     _activeGraphList.clear();
+    _activeIndexOfGraph.fill(-1, _graphData.size());
 
     for (qint32 idx = 0; idx < _graphData.size(); idx++)
     {
         if (_graphData[idx].isActive())
         {
+            _activeIndexOfGraph[idx] = _activeGraphList.size();
             _activeGraphList.append(idx);
         }
     }
@@ -404,26 +742,56 @@ void GraphDataModel::modelDataChanged()
     emit dataChanged(index(0, 0), index(rowCount() - 1, columnCount() - 1));
 }
 
-void GraphDataModel::addToModel(GraphData * pGraphData)
+void GraphDataModel::calculateFilterTimeout()
 {
-    /* Call function to prepare view */
-    beginInsertRows(QModelIndex(), size(), size());
+    if (calculateFilterChunks())
+    {
+        emit filterDataChanged();
+    }
+}
 
-    /* Select color */
-    if (!pGraphData->color().isValid())
+void GraphDataModel::addToModel(QList<GraphData> graphDataList)
+{
+    if (graphDataList.isEmpty())
     {
-        quint32 colorIndex = _graphData.size() % Util::cColorlist.size();
-        pGraphData->setColor(Util::cColorlist[colorIndex]);
+        return;
     }
 
-    _graphData.append(*pGraphData);
+    const qint32 firstIdx = size();
+
+    /* Call function to prepare view */
+    beginInsertRows(QModelIndex(), firstIdx, firstIdx + graphDataList.size() - 1);
+
+    _graphData.reserve(firstIdx + graphDataList.size());
+
+    for (qint32 idx = 0; idx < graphDataList.size(); idx++)
+    {
+        /* Select color */
+        if (!graphDataList[idx].color().isValid())
+        {
+            quint32 colorIndex = _graphData.size() % Util::cColorlist.size();
+            graphDataList[idx].setColor(Util::cColorlist[colorIndex]);
+        }
+
+        _graphData.append(graphDataList[idx]);
+    }
 
     updateActiveGraphList();
 
     /* Call function to trigger view update */
     endInsertRows();
 
-    emit added(size() - 1);
+    if (!recordBatchChange(true))
+    {
+        if (graphDataList.size() == 1)
+        {
+            emit added(firstIdx);
+        }
+        else
+        {
+            emit graphListChanged();
+        }
+    }
 }
 
 void GraphDataModel::removeFromModel(qint32 row)
@@ -432,9 +800,397 @@ void GraphDataModel::removeFromModel(qint32 row)
 
     _graphData.removeAt(row);
 
+    /* Filters refer to their source by index */
+    for (qint32 idx = 0; idx < _graphData.size(); idx++)
+    {
+        if (_graphData[idx].isFilter())
+        {
+            QSharedPointer<GraphFilter> pFilter = _graphData[idx].filter();
+
+            if (pFilter->sourceIndex() == row)
+            {
+                pFilter->setSourceIndex(-1);
+            }
+            else if (pFilter->sourceIndex() > row)
+            {
+                pFilter->setSourceIndex(pFilter->sourceIndex() - 1);
+            }
+        }
+    }
+
     updateActiveGraphList();
 
     endRemoveRows();
 
-    emit removed(row);
+    if (!recordBatchChange(true))
+    {
+        emit removed(row);
+    }
+}
+
+/*!
+ * Replace data of derived graph by the result of its expression
+ * The keys are taken from the longest parsed graph (all graphs share the time axis)
+ * The expression is compiled again every time, so it follows label changes
+ * Only samples that have changed are written, appended samples keep the index valid
+ */
+bool GraphDataModel::calculateDerived(quint32 index, QString * pError)
+{
+    Expression expression;
+    QString error;
+
+    if (!expression.compile(_graphData[index].expression(), labelList()))
+    {
+        error = expression.errorString();
+    }
+    else
+    {
+        foreach(qint32 refIdx, expression.references())
+        {
+            if (refIdx == Expression::cSelfReference)
+            {
+                error = QString("y can only be used in a marker expression");
+                break;
+            }
+            else if ((quint32)refIdx >= index)
+            {
+                /* Derived graphs are calculated in order of their index */
+                error = QString("%1 can't be used before it is calculated").arg(_graphData[refIdx].label());
+                break;
+            }
+        }
+    }
+
+    if (!error.isEmpty())
+    {
+        if (pError != NULL)
+        {
+            *pError = error;
+        }
+
+        return false;
+    }
+
+    const QCPGraphDataContainer * pKeyMap = NULL;
+    for (qint32 idx = 0; idx < _graphData.size(); idx++)
+    {
+        if (
+            !_graphData[idx].isDerived()
+            && !_graphData[idx].isFilter()
+            && ((pKeyMap == NULL) || (_graphData[idx].dataMap()->size() > pKeyMap->size()))
+            )
+        {
+            pKeyMap = _graphData[idx].dataMap().data();
+        }
+    }
+
+    QWriteLocker locker(&_dataLock);
+
+    const QCPRange fullRange(-QCPRange::maxRange, QCPRange::maxRange);
+    foreach(qint32 refIdx, expression.references())
+    {
+        if (_graphData[refIdx].isFilter() && _graphData[refIdx].isActive())
+        {
+            completeFilter(refIdx, fullRange);
+        }
+    }
+
+    QVector<QCPGraphData> newData;
+
+    if (pKeyMap != NULL)
+    {
+        QVector<Expression::Input> inputs;
+        foreach(qint32 refIdx, expression.references())
+        {
+            Expression::Input input;
+            input.pDataMap = _graphData[refIdx].dataMap().data();
+            input.gain = _graphData[refIdx].gain();
+            input.offset = _graphData[refIdx].offset();
+
+            inputs.append(input);
+        }
+
+        QVector<double> values(pKeyMap->size());
+        expression.evaluate(inputs, pKeyMap, 0, values.size(), values.data());
+
+        newData.resize(values.size());
+        for (qint32 sampleIdx = 0; sampleIdx < values.size(); sampleIdx++)
+        {
+            newData[sampleIdx] = QCPGraphData(pKeyMap->at(sampleIdx)->key, values[sampleIdx]);
+        }
+    }
+
+    /* Live updates mostly append samples: keep unchanged samples, so their index and tiles stay valid */
+    QSharedPointer<QCPGraphDataContainer> pDataMap = _graphData[index].dataMap();
+    const qint32 presentCount = pDataMap->size();
+
+    bool bSameKeys = presentCount <= newData.size();
+    qint32 changedBegin = presentCount;
+    qint32 changedEnd = 0;
+
+    QCPGraphDataContainer::iterator it = pDataMap->begin();
+    for (qint32 sampleIdx = 0; bSameKeys && (sampleIdx < presentCount); sampleIdx++, it++)
+    {
+        const double newValue = newData[sampleIdx].value;
+
+        if (it->key != newData[sampleIdx].key)
+        {
+            bSameKeys = false;
+        }
+        else if ((it->value != newValue) && !(qIsNaN(it->value) && qIsNaN(newValue)))
+        {
+            changedBegin = qMin(changedBegin, sampleIdx);
+            changedEnd = sampleIdx + 1;
+        }
+    }
+
+    if (bSameKeys)
+    {
+        it = pDataMap->begin() + changedBegin;
+        for (qint32 sampleIdx = changedBegin; sampleIdx < changedEnd; sampleIdx++, it++)
+        {
+            it->value = newData[sampleIdx].value;
+        }
+        _graphData[index].dataIndex()->invalidate(changedBegin, changedEnd);
+
+        if (newData.size() > presentCount)
+        {
+            pDataMap->add(newData.mid(presentCount), true);
+        }
+    }
+    else
+    {
+        pDataMap->set(newData, true);
+        _graphData[index].dataIndex()->invalidate();
+    }
+
+    return true;
+}
+
+/*!
+ * Calculate derived graph again, the expression can fail after labels or graphs have changed
+ * A failed graph has no data and shows its error (see derivedError)
+ */
+void GraphDataModel::recalculateDerived(quint32 index)
+{
+    QString error;
+
+    if (!calculateDerived(index, &error))
+    {
+        /* Don't keep showing the result of the previous calculation */
+        QWriteLocker locker(&_dataLock);
+        _graphData[index].dataMap()->clear();
+        _graphData[index].dataIndex()->invalidate();
+    }
+
+    if (error != _graphData[index].derivedError())
+    {
+        _graphData[index].setDerivedError(error);
+
+        if (!recordBatchChange(false))
+        {
+            emit labelChanged(index);
+        }
+    }
+}
+
+/*!
+ * Synchronize filter graph with its source, data lock should be held for writing
+ */
+bool GraphDataModel::synchronizeFilter(quint32 index)
+{
+    QSharedPointer<GraphFilter> pFilter = _graphData[index].filter();
+    const qint32 sourceIdx = pFilter->sourceIndex();
+
+    GraphFilter::SyncResult result = GraphFilter::SYNC_UNCHANGED;
+    const qint32 presentCount = _graphData[index].dataMap()->size();
+    qint32 modifiedBegin = presentCount;
+
+    if (sourceIdx == -1)
+    {
+        /* Source is removed */
+        if (!_graphData[index].dataMap()->isEmpty())
+        {
+            result = GraphFilter::SYNC_REPLACED;
+        }
+        _graphData[index].dataMap()->clear();
+    }
+    else
+    {
+        result = pFilter->synchronize(_graphData[sourceIdx].dataMap().data(),
+                                      _graphData[sourceIdx].dataIndex().data(),
+                                      _graphData[sourceIdx].gain(),
+                                      _graphData[sourceIdx].offset(),
+                                      _graphData[index].dataMap().data(),
+                                      &modifiedBegin);
+    }
+
+    /* Appended samples are indexed on the next query */
+    if (result == GraphFilter::SYNC_REPLACED)
+    {
+        _graphData[index].dataIndex()->invalidate();
+    }
+    else if (result == GraphFilter::SYNC_MODIFIED)
+    {
+        _graphData[index].dataIndex()->invalidate(modifiedBegin, presentCount);
+    }
+
+    return result != GraphFilter::SYNC_UNCHANGED;
+}
+
+/*!
+ * Calculate all chunks of filter graph that are in \a keyRange, data lock should be held for writing
+ * Returns true when the filter graph has changed
+ */
+bool GraphDataModel::completeFilter(quint32 index, const QCPRange &keyRange)
+{
+    QSharedPointer<GraphFilter> pFilter = _graphData[index].filter();
+
+    bool bChanged = synchronizeFilter(index);
+
+    if (pFilter->sourceIndex() != -1)
+    {
+        const QCPGraphDataContainer * pSource = _graphData[pFilter->sourceIndex()].dataMap().data();
+        QCPGraphDataContainer * pTarget = _graphData[index].dataMap().data();
+
+        qint32 chunk;
+        while ((chunk = pFilter->pendingChunk(pTarget, keyRange)) != -1)
+        {
+            qint32 beginIdx;
+            qint32 endIdx;
+            pFilter->calculateChunk(pSource, pTarget, chunk, &beginIdx, &endIdx);
+
+            _graphData[index].dataIndex()->invalidate(beginIdx, endIdx);
+            bChanged = true;
+        }
+    }
+
+    return bChanged;
+}
+
+/*!
+ * Calculate chunks of filter graphs that are in the filter key range, for at most _cFilterBudget
+ * The calculation continues in the next step when chunks are left
+ * Returns true when at least one chunk is calculated
+ */
+bool GraphDataModel::calculateFilterChunks()
+{
+    bool bCalculated = false;
+    bool bPending = false;
+
+    /* Called on every change of the visible range, the write lock would wait for the render thread */
+    if (!hasPendingFilterChunks(_filterKeyRange))
+    {
+        return false;
+    }
+
+    QElapsedTimer budgetTimer;
+    budgetTimer.start();
+
+    QWriteLocker locker(&_dataLock);
+
+    for (qint32 idx = 0; (idx < _graphData.size()) && !bPending; idx++)
+    {
+        if (
+            _graphData[idx].isFilter()
+            && _graphData[idx].isActive()
+            && (_graphData[idx].filter()->sourceIndex() != -1)
+            )
+        {
+            QSharedPointer<GraphFilter> pFilter = _graphData[idx].filter();
+            const QCPGraphDataContainer * pSource = _graphData[pFilter->sourceIndex()].dataMap().data();
+            QCPGraphDataContainer * pTarget = _graphData[idx].dataMap().data();
+
+            qint32 chunk;
+            while ((chunk = pFilter->pendingChunk(pTarget, _filterKeyRange)) != -1)
+            {
+                if (budgetTimer.elapsed() >= _cFilterBudget)
+                {
+                    bPending = true;
+                    break;
+                }
+
+                qint32 beginIdx;
+                qint32 endIdx;
+                pFilter->calculateChunk(pSource, pTarget, chunk, &beginIdx, &endIdx);
+
+                /* Only the calculated samples are indexed again */
+                _graphData[idx].dataIndex()->invalidate(beginIdx, endIdx);
+                bCalculated = true;
+            }
+        }
+    }
+
+    locker.unlock();
+
+    if (bPending)
+    {
+        _filterTimer.start();
+    }
+
+    return bCalculated;
+}
+
+/*!
+ * Check whether an active filter graph has chunks in \a keyRange that aren't calculated yet
+ * Doesn't take the data lock: data is only modified by the GUI thread, which is running this
+ */
+bool GraphDataModel::hasPendingFilterChunks(const QCPRange &keyRange)
+{
+    for (qint32 idx = 0; idx < _graphData.size(); idx++)
+    {
+        if (hasPendingFilterChunks(idx, keyRange))
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+/*!
+ * Check whether graph \a index is an active filter graph with chunks in \a keyRange that aren't calculated yet
+ */
+bool GraphDataModel::hasPendingFilterChunks(quint32 index, const QCPRange &keyRange)
+{
+    return _graphData[index].isFilter()
+            && _graphData[index].isActive()
+            && (_graphData[index].filter()->sourceIndex() != -1)
+            && (_graphData[index].filter()->pendingChunk(_graphData[index].dataMap().data(), keyRange) != -1);
+}
+
+QStringList GraphDataModel::labelList() const
+{
+    QStringList labels;
+    labels.reserve(_graphData.size());
+
+    foreach(GraphData graphData, _graphData)
+    {
+        labels.append(graphData.label());
+    }
+
+    return labels;
+}
+
+/*!
+ * Record change when in a batch (see beginUpdate)
+ * Returns true when the change is recorded, false when the signal should be emitted immediately
+ */
+bool GraphDataModel::recordBatchChange(bool bGraphList)
+{
+    if (_updateDepth == 0)
+    {
+        return false;
+    }
+
+    if (bGraphList)
+    {
+        _bGraphListChanged = true;
+    }
+    else
+    {
+        _bGraphPropertiesChanged = true;
+    }
+
+    return true;
 }
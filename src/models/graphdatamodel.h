@@ -4,6 +4,10 @@
 #include <QObject>
 #include <QAbstractTableModel>
 #include <QList>
+#include <QVector>
+#include <QStringList>
+#include <QReadWriteLock>
+#include <QTimer>
 
 //#include "communicationmanager.h"
 #include "graphdata.h"
@@ -15,6 +19,9 @@ class GraphDataModel : public QAbstractTableModel
 public:
     explicit GraphDataModel(QObject *parent = 0);
 
+    /* Sample value of graphs without samples, they are shown as a constant placeholder */
+    static const double cPlaceholderValue;
+
     /* Functions for QTableView (model) */
     int rowCount(const QModelIndex &parent = QModelIndex()) const ;
     int columnCount(const QModelIndex &parent = QModelIndex()) const;
@@ -35,17 +42,38 @@ public:
     QString label(quint32 index) const;
     QColor color(quint32 index) const;
     bool isActive(quint32 index) const;
+    double gain(quint32 index) const;
+    double offset(quint32 index) const;
+    bool isDerived(quint32 index) const;
+    QString expression(quint32 index) const;
+    QString derivedError(quint32 index) const;
+    bool isFilter(quint32 index) const;
+    QStringList labelList() const;
     QSharedPointer<QCPGraphDataContainer> dataMap(quint32 index);
+    QSharedPointer<QCPGraphDataContainer> dataMap(quint32 index, const QCPRange &keyRange);
+    QSharedPointer<GraphDataIndex> dataIndex(quint32 index);
+    QReadWriteLock * dataLock();
 
     void setVisible(quint32 index, bool bVisible);
     void setLabel(quint32 index, const QString &label);
     void setColor(quint32 index, const QColor &color);
     void setActive(quint32 index, bool bActive);
+    void setScaling(quint32 index, double gain, double offset);
+
+    void beginUpdate();
+    void endUpdate();
 
     void add(GraphData rowData);
     void add(QList<GraphData> graphDataList);
     void add();
     void add(QList<QString> labelList, QList<double> timeData, QList<QList<double> > data);
+    bool addDerived(const QString &label, const QString &expression, QString * pError);
+
+    bool addFilter(quint32 sourceIdx, GraphFilter::FilterType type, qint32 length);
+
+    bool updateDerivedGraphs();
+    bool updateFilterGraphs();
+    bool setFilterKeyRange(const QCPRange &keyRange);
 
     void removeRegister(qint32 idx);
     void clear();
@@ -61,12 +89,18 @@ signals:
     void labelChanged(const quint32 graphIdx);
     void colorChanged(const quint32 graphIdx);
     void activeChanged(const quint32 graphIdx); // when graph is actived / deactivated
+    void scalingChanged(const quint32 graphIdx); // when gain or offset is changed
 
     void graphsAddData(QList<double>, QList<QList<double> > data);
 
     void added(const quint32 idx); // When graph definition is added
     void removed(const quint32 idx); // When graph definition is removed
 
+    void graphListChanged(); // Once after a batch that added, removed or (de)activated graphs
+    void graphPropertiesChanged(); // Once after a batch that only changed visibility, label, color or scaling of graphs
+
+    void filterDataChanged(); // When samples of filter graphs are calculated
+
 public slots:
 
 private slots:
@@ -74,14 +108,39 @@ private slots:
     void modelDataChanged(qint32 idx);
     void modelDataChanged(quint32 idx);
     void modelDataChanged();
+    void calculateFilterTimeout();
 
 private:
     void updateActiveGraphList(void);
-    void addToModel(GraphData * pGraphData);
+    void addToModel(QList<GraphData> graphDataList);
     void removeFromModel(qint32 row);
+    bool recordBatchChange(bool bGraphList);
+    bool calculateDerived(quint32 index, QString * pError);
+    void recalculateDerived(quint32 index);
+    bool synchronizeFilter(quint32 index);
+    bool completeFilter(quint32 index, const QCPRange &keyRange);
+    bool calculateFilterChunks();
+    bool hasPendingFilterChunks(const QCPRange &keyRange);
+    bool hasPendingFilterChunks(quint32 index, const QCPRange &keyRange);
 
     QList<GraphData> _graphData;
-    QList<quint32> _activeGraphList;
+    QList<quint32> _activeGraphList; // sorted on graph index
+    QVector<qint32> _activeIndexOfGraph; // active index per graph index, -1 when not active
+
+    /* Nesting depth of beginUpdate, signals of single graphs are combined while non-zero */
+    qint32 _updateDepth;
+    bool _bActiveListDirty;
+    bool _bGraphListChanged;
+    bool _bGraphPropertiesChanged;
+
+    /* Held for writing while data containers are modified, for reading by render threads */
+    QReadWriteLock _dataLock;
+
+    /* Filter graphs are only calculated for this key range (visible range with margin) */
+    QCPRange _filterKeyRange;
+    QTimer _filterTimer;
+
+    static const qint32 _cFilterBudget = 20; // in milliseconds, per step of the filter calculation
 };
 
 #endif // GRAPHDATAMODEL_H
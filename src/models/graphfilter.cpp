@@ -0,0 +1,406 @@
+
+#include <QtMath>
+#include <algorithm> // std::lower_bound
+
+#include "graphdataindex.h"
+#include "graphfilter.h"
+
+const qint32 GraphFilter::_cChunkSize = 65536;
+const double GraphFilter::_cLowPassTolerance = 1e-9;
+
+GraphFilter::GraphFilter(FilterType type, qint32 length, qint32 sourceIdx)
+{
+    _type = type;
+    _length = qMax(length, 1);
+    _sourceIdx = sourceIdx;
+
+    _gain = 1;
+    _offset = 0;
+
+    _size = 0;
+    _sourceRevision = 0;
+}
+
+GraphFilter::FilterType GraphFilter::type() const
+{
+    return _type;
+}
+
+qint32 GraphFilter::length() const
+{
+    return _length;
+}
+
+QString GraphFilter::description() const
+{
+    return QString("%1 %2").arg(typeName(_type).toLower()).arg(_length);
+}
+
+qint32 GraphFilter::sourceIndex() const
+{
+    return _sourceIdx;
+}
+
+void GraphFilter::setSourceIndex(qint32 sourceIdx)
+{
+    _sourceIdx = sourceIdx;
+}
+
+QString GraphFilter::typeName(FilterType type)
+{
+    switch (type)
+    {
+    case FILTER_MOVING_AVERAGE:
+        return QString("Moving average");
+    case FILTER_LOW_PASS:
+        return QString("Low-pass");
+    case FILTER_MEDIAN:
+        return QString("Median");
+    case FILTER_DERIVATIVE:
+        return QString("Derivative");
+    default:
+        return QString();
+    }
+}
+
+/*!
+ * Follow changes of the source, \a pSourceIndex tells which samples of the source are modified
+ * Appended samples are calculated immediately. When values of the source are modified, the target
+ * samples from the first modified one are calculated again (SYNC_MODIFIED, from *pModifiedBegin).
+ * Otherwise the target is rebuilt with the keys of the source and all chunks are calculated again when requested
+ */
+GraphFilter::SyncResult GraphFilter::synchronize(const QCPGraphDataContainer * pSource, const GraphDataIndex * pSourceIndex, double gain, double offset,
+                                                 QCPGraphDataContainer * pTarget, qint32 * pModifiedBegin)
+{
+    SyncResult result = SYNC_UNCHANGED;
+    qint32 presentCount = pTarget->size();
+    const qint32 sourceSize = pSource->size();
+    const quint32 sourceRevision = pSourceIndex->revision();
+
+    /* Filters are causal: output before the first modified source sample stays the same */
+    qint32 modifiedBegin = presentCount;
+    if (sourceRevision != _sourceRevision)
+    {
+        modifiedBegin = pSourceIndex->firstChangedSample(_sourceRevision);
+    }
+
+    if (
+        (presentCount != _size)
+        || (gain != _gain)
+        || (offset != _offset)
+        || (presentCount > sourceSize)
+        || (modifiedBegin == 0)
+        )
+    {
+        /* Source is replaced, modified or scaled */
+        if (!pTarget->isEmpty())
+        {
+            result = SYNC_REPLACED;
+        }
+
+        pTarget->clear();
+        _chunkDone.clear();
+        presentCount = 0;
+
+        _gain = gain;
+        _offset = offset;
+    }
+    else if (modifiedBegin < presentCount)
+    {
+        if (presentCount - modifiedBegin <= _cChunkSize)
+        {
+            /* Short modified tail (live update): calculate again immediately, like appended samples */
+            calculate(pSource, pTarget, modifiedBegin, presentCount);
+        }
+        else
+        {
+            /* Chunks from the first modified sample are calculated again when requested */
+            modifiedBegin = modifiedBegin / _cChunkSize * _cChunkSize;
+
+            for (QCPGraphDataContainer::iterator it = pTarget->begin() + modifiedBegin; it != pTarget->end(); it++)
+            {
+                it->value = qQNaN();
+            }
+
+            for (qint32 chunk = modifiedBegin / _cChunkSize; chunk < _chunkDone.size(); chunk++)
+            {
+                _chunkDone[chunk] = false;
+            }
+        }
+
+        *pModifiedBegin = modifiedBegin;
+        result = SYNC_MODIFIED;
+    }
+
+    _sourceRevision = sourceRevision;
+
+    if (sourceSize > presentCount)
+    {
+        QVector<QCPGraphData> newData(sourceSize - presentCount);
+        for (qint32 idx = 0; idx < newData.size(); idx++)
+        {
+            newData[idx] = QCPGraphData(pSource->at(presentCount + idx)->key, qQNaN());
+        }
+
+        pTarget->add(newData, true);
+        _chunkDone.resize((sourceSize + _cChunkSize - 1) / _cChunkSize);
+
+        if (presentCount > 0)
+        {
+            /* Appended to data that is already shown: calculate incrementally */
+            calculate(pSource, pTarget, presentCount, sourceSize);
+
+            for (qint32 chunk = (presentCount + _cChunkSize - 1) / _cChunkSize; chunk < _chunkDone.size(); chunk++)
+            {
+                _chunkDone[chunk] = true;
+            }
+        }
+
+        if (result == SYNC_UNCHANGED)
+        {
+            result = SYNC_APPENDED;
+        }
+    }
+
+    _size = pTarget->size();
+
+    return result;
+}
+
+/*!
+ * First chunk that overlaps \a keyRange and isn't calculated yet, -1 when there is none
+ */
+qint32 GraphFilter::pendingChunk(const QCPGraphDataContainer * pTarget, const QCPRange &keyRange) const
+{
+    if (pTarget->isEmpty())
+    {
+        return -1;
+    }
+
+    const qint32 beginIdx = pTarget->findBegin(keyRange.lower, false) - pTarget->constBegin();
+    const qint32 endIdx = pTarget->findEnd(keyRange.upper, false) - pTarget->constBegin();
+
+    if (endIdx <= beginIdx)
+    {
+        return -1;
+    }
+
+    for (qint32 chunk = beginIdx / _cChunkSize; chunk <= (endIdx - 1) / _cChunkSize; chunk++)
+    {
+        if (!_chunkDone[chunk])
+        {
+            return chunk;
+        }
+    }
+
+    return -1;
+}
+
+/*!
+ * Calculate target samples of \a chunk, the calculated samples are [*pBeginIdx, *pEndIdx[
+ */
+void GraphFilter::calculateChunk(const QCPGraphDataContainer * pSource, QCPGraphDataContainer * pTarget, qint32 chunk, qint32 * pBeginIdx, qint32 * pEndIdx)
+{
+    const qint32 beginIdx = chunk * _cChunkSize;
+    const qint32 endIdx = qMin(beginIdx + _cChunkSize, pTarget->size());
+
+    calculate(pSource, pTarget, beginIdx, endIdx);
+
+    _chunkDone[chunk] = true;
+
+    *pBeginIdx = beginIdx;
+    *pEndIdx = endIdx;
+}
+
+/*!
+ * Calculate target samples [beginIdx, endIdx[, NaN samples of the source are ignored
+ */
+void GraphFilter::calculate(const QCPGraphDataContainer * pSource, QCPGraphDataContainer * pTarget, qint32 beginIdx, qint32 endIdx) const
+{
+    switch (_type)
+    {
+    case FILTER_MOVING_AVERAGE:
+        movingAverage(pSource, pTarget, beginIdx, endIdx);
+        break;
+    case FILTER_LOW_PASS:
+        lowPass(pSource, pTarget, beginIdx, endIdx);
+        break;
+    case FILTER_MEDIAN:
+        median(pSource, pTarget, beginIdx, endIdx);
+        break;
+    case FILTER_DERIVATIVE:
+        derivative(pSource, pTarget, beginIdx, endIdx);
+        break;
+    default:
+        break;
+    }
+}
+
+/*!
+ * Average of the last _length samples, the running sum is started again for every chunk
+ */
+void GraphFilter::movingAverage(const QCPGraphDataContainer * pSource, QCPGraphDataContainer * pTarget, qint32 beginIdx, qint32 endIdx) const
+{
+    const qint32 firstIdx = qMax(0, beginIdx - _length + 1);
+
+    double sum = 0;
+    qint32 count = 0;
+
+    for (qint32 idx = firstIdx; idx < beginIdx; idx++)
+    {
+        const double value = sourceValue(pSource, idx);
+        if (!qIsNaN(value))
+        {
+            sum += value;
+            count++;
+        }
+    }
+
+    QCPGraphDataContainer::iterator it = pTarget->begin() + beginIdx;
+    for (qint32 idx = beginIdx; idx < endIdx; idx++, it++)
+    {
+        const double value = sourceValue(pSource, idx);
+        if (!qIsNaN(value))
+        {
+            sum += value;
+            count++;
+        }
+
+        if (idx - _length >= firstIdx)
+        {
+            const double oldValue = sourceValue(pSource, idx - _length);
+            if (!qIsNaN(oldValue))
+            {
+                sum -= oldValue;
+                count--;
+            }
+        }
+
+        it->value = count > 0 ? sum / count : qQNaN();
+    }
+}
+
+/*!
+ * First order low-pass (exponential moving average) with a time constant of _length samples
+ */
+void GraphFilter::lowPass(const QCPGraphDataContainer * pSource, QCPGraphDataContainer * pTarget, qint32 beginIdx, qint32 endIdx) const
+{
+    const double alpha = 1.0 / _length;
+    double state = qQNaN();
+
+    if (beginIdx > 0)
+    {
+        const double previous = (pTarget->constBegin() + beginIdx - 1)->value;
+
+        if (!qIsNaN(previous))
+        {
+            state = previous;
+        }
+        else
+        {
+            /* Previous output isn't calculated: start where the older history is negligible */
+            const qint32 warmUpCount = alpha < 1 ? qCeil(qLn(_cLowPassTolerance) / qLn(1 - alpha)) : 0;
+
+            for (qint32 idx = qMax(0, beginIdx - warmUpCount); idx < beginIdx; idx++)
+            {
+                const double value = sourceValue(pSource, idx);
+                if (!qIsNaN(value))
+                {
+                    state = qIsNaN(state) ? value : state + alpha * (value - state);
+                }
+            }
+        }
+    }
+
+    QCPGraphDataContainer::iterator it = pTarget->begin() + beginIdx;
+    for (qint32 idx = beginIdx; idx < endIdx; idx++, it++)
+    {
+        const double value = sourceValue(pSource, idx);
+        if (!qIsNaN(value))
+        {
+            state = qIsNaN(state) ? value : state + alpha * (value - state);
+        }
+
+        it->value = state;
+    }
+}
+
+/*!
+ * Median of the last _length samples, the window is kept sorted
+ */
+void GraphFilter::median(const QCPGraphDataContainer * pSource, QCPGraphDataContainer * pTarget, qint32 beginIdx, qint32 endIdx) const
+{
+    const qint32 firstIdx = qMax(0, beginIdx - _length + 1);
+
+    QVector<double> window;
+    window.reserve(_length);
+
+    for (qint32 idx = firstIdx; idx < beginIdx; idx++)
+    {
+        const double value = sourceValue(pSource, idx);
+        if (!qIsNaN(value))
+        {
+            window.insert(std::lower_bound(window.begin(), window.end(), value), value);
+        }
+    }
+
+    QCPGraphDataContainer::iterator it = pTarget->begin() + beginIdx;
+    for (qint32 idx = beginIdx; idx < endIdx; idx++, it++)
+    {
+        const double value = sourceValue(pSource, idx);
+        if (!qIsNaN(value))
+        {
+            window.insert(std::lower_bound(window.begin(), window.end(), value), value);
+        }
+
+        if (idx - _length >= firstIdx)
+        {
+            const double oldValue = sourceValue(pSource, idx - _length);
+            if (!qIsNaN(oldValue))
+            {
+                window.erase(std::lower_bound(window.begin(), window.end(), oldValue));
+            }
+        }
+
+        const qint32 count = window.size();
+        if (count == 0)
+        {
+            it->value = qQNaN();
+        }
+        else if (count % 2)
+        {
+            it->value = window[count / 2];
+        }
+        else
+        {
+            it->value = (window[count / 2 - 1] + window[count / 2]) / 2;
+        }
+    }
+}
+
+/*!
+ * Change per second over the last _length samples
+ */
+void GraphFilter::derivative(const QCPGraphDataContainer * pSource, QCPGraphDataContainer * pTarget, qint32 beginIdx, qint32 endIdx) const
+{
+    QCPGraphDataContainer::iterator it = pTarget->begin() + beginIdx;
+    for (qint32 idx = beginIdx; idx < endIdx; idx++, it++)
+    {
+        const qint32 previousIdx = qMax(0, idx - _length);
+        const double timeDiff = (pSource->at(idx)->key - pSource->at(previousIdx)->key) / 1000;
+
+        if (timeDiff != 0)
+        {
+            it->value = (sourceValue(pSource, idx) - sourceValue(pSource, previousIdx)) / timeDiff;
+        }
+        else
+        {
+            it->value = 0;
+        }
+    }
+}
+
+double GraphFilter::sourceValue(const QCPGraphDataContainer * pSource, qint32 idx) const
+{
+    return _gain * pSource->at(idx)->value + _offset;
+}
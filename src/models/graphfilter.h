@@ -0,0 +1,93 @@
+#ifndef GRAPHFILTER_H
+#define GRAPHFILTER_H
+
+#include <QString>
+#include <QVector>
+#include "qcustomplot.h"
+
+/* Forward declaration */
+class GraphDataIndex;
+
+/*
+ * Filter that calculates a graph from the samples of a source graph
+ *
+ * All filters are causal and only look back a limited number of samples, so the result
+ * is calculated lazily per chunk of _cChunkSize samples: only chunks that are requested
+ * (visible range) are calculated, calculated chunks are kept. The low-pass filter has an
+ * infinite response, a chunk starts from the previous output when it is available,
+ * otherwise from a warm-up period in which the history has decayed below _cLowPassTolerance.
+ *
+ * The target has the keys of the source, samples that aren't calculated yet are NaN.
+ * Samples that are appended to the source are calculated immediately. When existing samples
+ * of the source change (revision of its index), the target is calculated again from the first
+ * changed sample: immediately for a short tail (live update), otherwise per chunk when requested.
+ * */
+class GraphFilter
+{
+
+public:
+
+    typedef enum
+    {
+        FILTER_MOVING_AVERAGE = 0,
+        FILTER_LOW_PASS,
+        FILTER_MEDIAN,
+        FILTER_DERIVATIVE,
+
+    } FilterType;
+
+    typedef enum
+    {
+        SYNC_UNCHANGED = 0,
+        SYNC_APPENDED, // only new samples are added to the target
+        SYNC_MODIFIED, // values of existing samples from the modified begin have changed, new samples can be added
+        SYNC_REPLACED, // existing samples of the target have changed
+
+    } SyncResult;
+
+    explicit GraphFilter(FilterType type, qint32 length, qint32 sourceIdx);
+
+    FilterType type() const;
+    qint32 length() const;
+    QString description() const;
+
+    qint32 sourceIndex() const;
+    void setSourceIndex(qint32 sourceIdx);
+
+    static QString typeName(FilterType type);
+
+    SyncResult synchronize(const QCPGraphDataContainer * pSource, const GraphDataIndex * pSourceIndex, double gain, double offset,
+                           QCPGraphDataContainer * pTarget, qint32 * pModifiedBegin);
+
+    qint32 pendingChunk(const QCPGraphDataContainer * pTarget, const QCPRange &keyRange) const;
+    void calculateChunk(const QCPGraphDataContainer * pSource, QCPGraphDataContainer * pTarget, qint32 chunk, qint32 * pBeginIdx, qint32 * pEndIdx);
+
+private:
+
+    void calculate(const QCPGraphDataContainer * pSource, QCPGraphDataContainer * pTarget, qint32 beginIdx, qint32 endIdx) const;
+
+    void movingAverage(const QCPGraphDataContainer * pSource, QCPGraphDataContainer * pTarget, qint32 beginIdx, qint32 endIdx) const;
+    void lowPass(const QCPGraphDataContainer * pSource, QCPGraphDataContainer * pTarget, qint32 beginIdx, qint32 endIdx) const;
+    void median(const QCPGraphDataContainer * pSource, QCPGraphDataContainer * pTarget, qint32 beginIdx, qint32 endIdx) const;
+    void derivative(const QCPGraphDataContainer * pSource, QCPGraphDataContainer * pTarget, qint32 beginIdx, qint32 endIdx) const;
+
+    double sourceValue(const QCPGraphDataContainer * pSource, qint32 idx) const;
+
+    FilterType _type;
+    qint32 _length; // window in samples, time constant for low-pass
+    qint32 _sourceIdx; // -1 when source is removed
+
+    /* Scaling of source that is applied to the filter input */
+    double _gain;
+    double _offset;
+
+    qint32 _size; // size of target after last synchronize
+    quint32 _sourceRevision; // revision of source index after last synchronize
+    QVector<bool> _chunkDone;
+
+    static const qint32 _cChunkSize;
+    static const double _cLowPassTolerance;
+
+};
+
+#endif // GRAPHFILTER_H
@@ -13,6 +13,13 @@ const quint32 GuiModel::cAverageMask       = 1 << 2;
 const quint32 GuiModel::cMinimumMask       = 1 << 3;
 const quint32 GuiModel::cMaximumMask       = 1 << 4;
 const quint32 GuiModel::cCustomMask        = 1 << 5;
+const quint32 GuiModel::cStdDevMask        = 1 << 6;
+const quint32 GuiModel::cRmsMask           = 1 << 7;
+const quint32 GuiModel::cIntegralMask      = 1 << 8;
+const quint32 GuiModel::cSampleCountMask   = 1 << 9;
+const quint32 GuiModel::cMedianMask        = 1 << 10;
+const quint32 GuiModel::cPercentile95Mask  = 1 << 11;
+const quint32 GuiModel::cPercentile99Mask  = 1 << 12;
 
 const QStringList GuiModel::cMarkerExpressionStrings = QStringList()
                                                         <<  "Diff: %0\n"
@@ -20,6 +27,13 @@ const QStringList GuiModel::cMarkerExpressionStrings = QStringList()
                                                         <<  "Avg: %0\n"
                                                         <<  "Min: %0\n"
                                                         <<  "Max: %0\n"
+                                                        <<  "StdDev: %0\n"
+                                                        <<  "RMS: %0\n"
+                                                        <<  "Integral: %0\n"
+                                                        <<  "Count: %0\n"
+                                                        <<  "Median: %0\n"
+                                                        <<  "P95: %0\n"
+                                                        <<  "P99: %0\n"
                                                         <<  "Custom: %0\n";
 
 const QList<quint32> GuiModel::cMarkerExpressionBits = QList<quint32>()
@@ -28,6 +42,13 @@ const QList<quint32> GuiModel::cMarkerExpressionBits = QList<quint32>()
                         << GuiModel::cAverageMask
                         << GuiModel::cMinimumMask
                         << GuiModel::cMaximumMask
+                        << GuiModel::cStdDevMask
+                        << GuiModel::cRmsMask
+                        << GuiModel::cIntegralMask
+                        << GuiModel::cSampleCountMask
+                        << GuiModel::cMedianMask
+                        << GuiModel::cPercentile95Mask
+                        << GuiModel::cPercentile99Mask
                         << GuiModel::cCustomMask
                         ;
 const QString GuiModel::cMarkerExpressionStart = QString("y1: %0\n");
@@ -38,6 +59,7 @@ GuiModel::GuiModel(QObject *parent) : QObject(parent)
     _frontGraph = 0;
     _dataFilePath = "";
     _bHighlightSamples = true;
+    _bDensityMode = false;
     _bCursorValues = false;
     _guiState = INIT;
     _windowTitle = _cWindowTitle;
@@ -73,6 +95,7 @@ void GuiModel::triggerUpdate(void)
 {
     emit frontGraphChanged();
     emit highlightSamplesChanged();
+    emit densityModeChanged();
     emit cursorValuesChanged();
     emit windowTitleChanged();
     emit watchFileChanged();
@@ -134,6 +157,20 @@ void GuiModel::setHighlightSamples(bool bHighlightSamples)
     }
 }
 
+bool GuiModel::densityMode() const
+{
+    return _bDensityMode;
+}
+
+void GuiModel::setDensityMode(bool bDensityMode)
+{
+    if (_bDensityMode != bDensityMode)
+    {
+        _bDensityMode = bDensityMode;
+        emit densityModeChanged();
+    }
+}
+
 bool GuiModel::cursorValues() const
 {
     return _bCursorValues;
@@ -218,10 +255,11 @@ BasicGraphView::AxisScaleOptions GuiModel::yAxisScalingMode()
 
 void GuiModel::setyAxisScale(BasicGraphView::AxisScaleOptions scaleMode)
 {
-    // We only allow manual or auto
+    // We only allow manual, auto or window auto
     if (
             (scaleMode != BasicGraphView::SCALE_MANUAL)
             && (scaleMode != BasicGraphView::SCALE_AUTO)
+            && (scaleMode != BasicGraphView::SCALE_WINDOW_AUTO)
         )
     {
         scaleMode = BasicGraphView::SCALE_AUTO;
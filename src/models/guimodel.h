@@ -19,6 +19,13 @@ public:
     static const quint32 cMinimumMask;
     static const quint32 cMaximumMask;
     static const quint32 cCustomMask;
+    static const quint32 cStdDevMask;
+    static const quint32 cRmsMask;
+    static const quint32 cIntegralMask;
+    static const quint32 cSampleCountMask;
+    static const quint32 cMedianMask;
+    static const quint32 cPercentile95Mask;
+    static const quint32 cPercentile99Mask;
 
     static const QStringList cMarkerExpressionStrings;
     static const QList<quint32> cMarkerExpressionBits;
@@ -37,6 +44,7 @@ public:
     qint32 frontGraph() const;
     bool watchFile() const;
     bool highlightSamples() const;
+    bool densityMode() const;
     bool cursorValues() const;
     QString windowTitle();
     QString dataFilePath();
@@ -60,6 +68,7 @@ public:
 public slots:
     void setCursorValues(bool bCursorValues);
     void setHighlightSamples(bool bHighlightSamples);
+    void setDensityMode(bool bDensityMode);
     void setWatchFile(bool bWatchFile);
     void setFrontGraph(const qint32 &frontGraph);
 
@@ -73,6 +82,7 @@ signals:
 
     void frontGraphChanged();
     void highlightSamplesChanged();
+    void densityModeChanged();
     void cursorValuesChanged();
     void windowTitleChanged();
     void watchFileChanged();
@@ -111,6 +121,7 @@ private:
     QString _lastDir; // Last directory opened for import/export/load project
 
     bool _bHighlightSamples;
+    bool _bDensityMode;
     bool _bCursorValues;
     quint32 _guiState;
 
@@ -0,0 +1,212 @@
+
+#include <QtMath>
+
+#include "guimodel.h"
+#include "graphdatamodel.h"
+#include "markerexpression.h"
+
+/*!
+ * Calculate value of marker expression (\a expressionMask) of a graph between \a startPos and \a endPos
+ *
+ * The result is in shown units (\a gain * sample + \a offset), it is derived from
+ * the statistics of the unmodified samples. A graph without samples is a placeholder
+ * with a constant value (see GraphDataModel::cPlaceholderValue).
+ *
+ * Doesn't modify the graph data, so it can be called from multiple threads
+ * as long as the index is synchronized beforehand (GraphDataIndex::synchronize)
+ */
+double MarkerExpression::calculate(QSharedPointer<QCPGraphDataContainer> pDataMap, QSharedPointer<GraphDataIndex> pDataIndex, double startPos, double endPos, quint32 expressionMask, double gain, double offset)
+{
+    double result = 0;
+
+    if (!pDataMap->isEmpty())
+    {
+        const double valueDiff = gain * (pDataMap->findBegin(endPos, false)->value - pDataMap->findBegin(startPos, false)->value);
+        const double timeDiff = endPos - startPos;
+
+        /* make sure we go in ascending order */
+        const double lowerPos = qMin(startPos, endPos);
+        const double upperPos = qMax(startPos, endPos);
+
+        const qint32 beginIdx = pDataMap->findBegin(lowerPos, false) - pDataMap->constBegin();
+        const qint32 endIdx = pDataMap->findEnd(upperPos, false) - pDataMap->constBegin();
+
+        if (expressionMask == GuiModel::cDifferenceMask)
+        {
+            result = valueDiff;
+        }
+        else if (expressionMask == GuiModel::cSlopeMask)
+        {
+            result = valueDiff / (timeDiff / 1000); // per second, TODO: round?
+        }
+        else if (
+                 (expressionMask == GuiModel::cMinimumMask)
+                 || (expressionMask == GuiModel::cMaximumMask)
+                 )
+        {
+            bool bFound;
+            const QCPRange valueRange = pDataIndex->valueRange(bFound, beginIdx, endIdx);
+
+            if (!bFound)
+            {
+                result = 0;
+            }
+            else if ((expressionMask == GuiModel::cMinimumMask) == (gain >= 0))
+            {
+                /* Negative gain swaps minimum and maximum */
+                result = gain * valueRange.lower + offset;
+            }
+            else
+            {
+                result = gain * valueRange.upper + offset;
+            }
+        }
+        else if (
+                 (expressionMask == GuiModel::cAverageMask)
+                 || (expressionMask == GuiModel::cStdDevMask)
+                 || (expressionMask == GuiModel::cRmsMask)
+                 || (expressionMask == GuiModel::cIntegralMask)
+                 || (expressionMask == GuiModel::cSampleCountMask)
+                 )
+        {
+            const GraphDataIndex::Statistics statistics = pDataIndex->statistics(beginIdx, endIdx);
+
+            if (expressionMask == GuiModel::cAverageMask)
+            {
+                result = gain * statistics.mean + offset;
+            }
+            else if (expressionMask == GuiModel::cStdDevMask)
+            {
+                result = qAbs(gain) * qSqrt(statistics.variance);
+            }
+            else if (expressionMask == GuiModel::cRmsMask)
+            {
+                /* E[(g * x + o)^2] = g^2 * E[x^2] + 2 * g * o * E[x] + o^2 */
+                const double meanSquare = gain * gain * statistics.meanSquare + 2 * gain * offset * statistics.mean + offset * offset;
+                result = qSqrt(qMax(meanSquare, 0.0));
+            }
+            else if (expressionMask == GuiModel::cIntegralMask)
+            {
+                /* Offset adds its area over the samples in range (NaN gaps are included) */
+                double keySpan = 0;
+                if (endIdx - beginIdx >= 2)
+                {
+                    keySpan = pDataMap->at(endIdx - 1)->key - pDataMap->at(beginIdx)->key;
+                }
+
+                result = (gain * statistics.integral + offset * keySpan) / 1000; // value * second
+            }
+            else
+            {
+                result = statistics.count;
+            }
+        }
+        else if (
+                 (expressionMask == GuiModel::cMedianMask)
+                 || (expressionMask == GuiModel::cPercentile95Mask)
+                 || (expressionMask == GuiModel::cPercentile99Mask)
+                 )
+        {
+            double fraction;
+            if (expressionMask == GuiModel::cMedianMask)
+            {
+                fraction = 0.5;
+            }
+            else if (expressionMask == GuiModel::cPercentile95Mask)
+            {
+                fraction = 0.95;
+            }
+            else
+            {
+                fraction = 0.99;
+            }
+
+            /* Negative gain reverses the order of the samples */
+            if (gain < 0)
+            {
+                fraction = 1 - fraction;
+            }
+
+            /* Approximate for large ranges, see GraphDataIndex */
+            bool bFound;
+            result = gain * pDataIndex->quantile(bFound, beginIdx, endIdx, fraction) + offset;
+
+            if (!bFound)
+            {
+                result = 0;
+            }
+        }
+        else
+        {
+            result = 0;
+        }
+    }
+    else
+    {
+        result = calculateConstant(gain * GraphDataModel::cPlaceholderValue + offset, startPos, endPos, expressionMask);
+    }
+
+    return result;
+}
+
+/*!
+ * Value of marker expression for a graph that has the constant (shown) \a value everywhere
+ */
+double MarkerExpression::calculateConstant(double value, double startPos, double endPos, quint32 expressionMask)
+{
+    if (
+        (expressionMask == GuiModel::cAverageMask)
+        || (expressionMask == GuiModel::cMinimumMask)
+        || (expressionMask == GuiModel::cMaximumMask)
+        || (expressionMask == GuiModel::cMedianMask)
+        || (expressionMask == GuiModel::cPercentile95Mask)
+        || (expressionMask == GuiModel::cPercentile99Mask)
+        )
+    {
+        return value;
+    }
+    else if (expressionMask == GuiModel::cRmsMask)
+    {
+        return qAbs(value);
+    }
+    else if (expressionMask == GuiModel::cIntegralMask)
+    {
+        return value * qAbs(endPos - startPos) / 1000; // value * second
+    }
+    else
+    {
+        /* Difference, slope, standard deviation and sample count */
+        return 0;
+    }
+}
+
+/*!
+ * Calculate custom marker expression (see Expression) of a graph between \a startPos and \a endPos
+ *
+ * The expression is evaluated for every sample between the markers, the result is the value
+ * at the last sample. So integ(y) is the integral and deriv(y) the slope at the end marker.
+ * \a inputs holds the graphs referenced by the expression, \a pDataMap is the graph itself (y).
+ */
+double MarkerExpression::calculateCustom(const Expression &expression, const QVector<Expression::Input> &inputs, QSharedPointer<QCPGraphDataContainer> pDataMap, double startPos, double endPos)
+{
+    double result = 0;
+
+    if (expression.isValid() && !pDataMap->isEmpty())
+    {
+        const double lowerPos = qMin(startPos, endPos);
+        const double upperPos = qMax(startPos, endPos);
+
+        const qint32 beginIdx = pDataMap->findBegin(lowerPos, false) - pDataMap->constBegin();
+        const qint32 endIdx = pDataMap->findEnd(upperPos, false) - pDataMap->constBegin();
+
+        if (endIdx > beginIdx)
+        {
+            QVector<double> values(endIdx - beginIdx);
+            expression.evaluate(inputs, pDataMap.data(), beginIdx, endIdx, values.data());
+
+            result = values.last();
+        }
+    }
+
+    return result;
+}
@@ -0,0 +1,20 @@
+#ifndef MARKEREXPRESSION_H
+#define MARKEREXPRESSION_H
+
+#include "qcustomplot.h"
+#include "graphdataindex.h"
+#include "expression.h"
+
+class MarkerExpression
+{
+
+public:
+    static double calculate(QSharedPointer<QCPGraphDataContainer> pDataMap, QSharedPointer<GraphDataIndex> pDataIndex, double startPos, double endPos, quint32 expressionMask, double gain, double offset);
+    static double calculateCustom(const Expression &expression, const QVector<Expression::Input> &inputs, QSharedPointer<QCPGraphDataContainer> pDataMap, double startPos, double endPos);
+
+private:
+    static double calculateConstant(double value, double startPos, double endPos, quint32 expressionMask);
+
+};
+
+#endif // MARKEREXPRESSION_H
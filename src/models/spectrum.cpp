@@ -0,0 +1,224 @@
+
+#include <QtMath>
+
+#include "spectrum.h"
+
+/*!
+ * Calculate spectrum of \a samples, sampled at \a sampleRate (Hz)
+ * When \a pGeneration is set, the calculation stops (invalid result) as soon as it differs from \a generation
+ */
+Spectrum::Result Spectrum::calculate(const QVector<double> &samples, double sampleRate, qint32 segmentLength, const QAtomicInt * pGeneration, qint32 generation)
+{
+    Result result;
+    result.bValid = false;
+    result.sampleRate = sampleRate;
+    result.segmentLength = segmentLength;
+    result.segmentCount = 0;
+
+    if (
+        (segmentLength < 2)
+        || ((segmentLength & (segmentLength - 1)) != 0)
+        || (samples.size() < segmentLength)
+        || !(sampleRate > 0)
+        )
+    {
+        return result;
+    }
+
+    const qint32 hop = segmentLength / 2;
+    const qint32 segmentCount = (samples.size() - segmentLength) / hop + 1;
+    const qint32 binCount = segmentLength / 2 + 1;
+
+    /* Periodic Hann window */
+    QVector<double> window(segmentLength);
+    double windowSum = 0;
+    for (qint32 idx = 0; idx < segmentLength; idx++)
+    {
+        window[idx] = 0.5 * (1 - qCos(2 * M_PI * idx / segmentLength));
+        windowSum += window[idx];
+    }
+
+    const FftPlan plan = createPlan(segmentLength);
+
+    QVector<double> power(binCount, 0);
+    QVector<double> real(segmentLength);
+    QVector<double> imag(segmentLength);
+
+    /* Two real segments per complex FFT: one in the real part, one in the imaginary part */
+    for (qint32 segment = 0; segment < segmentCount; segment += 2)
+    {
+        if ((pGeneration != NULL) && (pGeneration->load() != generation))
+        {
+            /* Request is outdated */
+            return result;
+        }
+
+        const bool bPair = (segment + 1) < segmentCount;
+
+        loadSegment(samples.constData() + segment * hop, window, segmentLength, real.data());
+
+        if (bPair)
+        {
+            loadSegment(samples.constData() + (segment + 1) * hop, window, segmentLength, imag.data());
+        }
+        else
+        {
+            imag.fill(0);
+        }
+
+        transform(plan, real.data(), imag.data());
+
+        for (qint32 bin = 0; bin < binCount; bin++)
+        {
+            const qint32 mirror = (segmentLength - bin) & (segmentLength - 1);
+
+            const double firstReal = (real[bin] + real[mirror]) / 2;
+            const double firstImag = (imag[bin] - imag[mirror]) / 2;
+            power[bin] += firstReal * firstReal + firstImag * firstImag;
+
+            if (bPair)
+            {
+                const double secondReal = (imag[bin] + imag[mirror]) / 2;
+                const double secondImag = (real[mirror] - real[bin]) / 2;
+                power[bin] += secondReal * secondReal + secondImag * secondImag;
+            }
+        }
+    }
+
+    result.segmentCount = segmentCount;
+    result.frequencies.resize(binCount);
+    result.amplitudes.resize(binCount);
+
+    for (qint32 bin = 0; bin < binCount; bin++)
+    {
+        /* Single sided: all bins except DC and Nyquist contain half of the power */
+        const double scale = ((bin == 0) || (bin == binCount - 1)) ? 1 : M_SQRT2;
+
+        result.frequencies[bin] = bin * sampleRate / segmentLength;
+        result.amplitudes[bin] = scale * qSqrt(power[bin] / segmentCount) / windowSum;
+    }
+
+    result.bValid = true;
+
+    return result;
+}
+
+/*!
+ * Largest power of two that isn't larger than \a sampleCount and \a maxSegmentLength, 0 when there is none
+ */
+qint32 Spectrum::segmentLength(qint32 sampleCount, qint32 maxSegmentLength)
+{
+    const qint32 limit = qMin(sampleCount, maxSegmentLength);
+
+    if (limit < 2)
+    {
+        return 0;
+    }
+
+    qint32 length = 2;
+    while (length * 2 <= limit)
+    {
+        length *= 2;
+    }
+
+    return length;
+}
+
+Spectrum::FftPlan Spectrum::createPlan(qint32 length)
+{
+    FftPlan plan;
+    plan.length = length;
+
+    qint32 bitCount = 0;
+    while ((1 << bitCount) < length)
+    {
+        bitCount++;
+    }
+
+    plan.bitReverse.resize(length);
+    for (qint32 idx = 0; idx < length; idx++)
+    {
+        qint32 reversed = 0;
+        for (qint32 bit = 0; bit < bitCount; bit++)
+        {
+            reversed |= ((idx >> bit) & 1) << (bitCount - 1 - bit);
+        }
+        plan.bitReverse[idx] = reversed;
+    }
+
+    plan.cosTable.resize(length / 2);
+    plan.sinTable.resize(length / 2);
+    for (qint32 idx = 0; idx < length / 2; idx++)
+    {
+        plan.cosTable[idx] = qCos(2 * M_PI * idx / length);
+        plan.sinTable[idx] = -qSin(2 * M_PI * idx / length);
+    }
+
+    return plan;
+}
+
+/*!
+ * In-place forward FFT (radix-2, decimation in time)
+ */
+void Spectrum::transform(const FftPlan &plan, double * pReal, double * pImag)
+{
+    const qint32 length = plan.length;
+
+    for (qint32 idx = 0; idx < length; idx++)
+    {
+        const qint32 reversed = plan.bitReverse[idx];
+        if (reversed > idx)
+        {
+            qSwap(pReal[idx], pReal[reversed]);
+            qSwap(pImag[idx], pImag[reversed]);
+        }
+    }
+
+    for (qint32 size = 2; size <= length; size *= 2)
+    {
+        const qint32 half = size / 2;
+        const qint32 tableStep = length / size;
+
+        for (qint32 start = 0; start < length; start += size)
+        {
+            double * pReal0 = pReal + start;
+            double * pImag0 = pImag + start;
+            double * pReal1 = pReal0 + half;
+            double * pImag1 = pImag0 + half;
+
+            for (qint32 k = 0; k < half; k++)
+            {
+                const double twiddleReal = plan.cosTable[k * tableStep];
+                const double twiddleImag = plan.sinTable[k * tableStep];
+
+                const double tempReal = twiddleReal * pReal1[k] - twiddleImag * pImag1[k];
+                const double tempImag = twiddleReal * pImag1[k] + twiddleImag * pReal1[k];
+
+                pReal1[k] = pReal0[k] - tempReal;
+                pImag1[k] = pImag0[k] - tempImag;
+                pReal0[k] += tempReal;
+                pImag0[k] += tempImag;
+            }
+        }
+    }
+}
+
+/*!
+ * Copy segment without its mean and multiplied with the window
+ */
+void Spectrum::loadSegment(const double * pSamples, const QVector<double> &window, qint32 length, double * pDst)
+{
+    double sum = 0;
+    for (qint32 idx = 0; idx < length; idx++)
+    {
+        sum += pSamples[idx];
+    }
+
+    const double mean = sum / length;
+    const double * pWindow = window.constData();
+
+    for (qint32 idx = 0; idx < length; idx++)
+    {
+        pDst[idx] = (pSamples[idx] - mean) * pWindow[idx];
+    }
+}
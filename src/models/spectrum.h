@@ -0,0 +1,55 @@
+#ifndef SPECTRUM_H
+#define SPECTRUM_H
+
+#include <QVector>
+#include <QAtomicInt>
+
+/*
+ * Amplitude spectrum of uniformly sampled data with Welch averaging
+ *
+ * The samples are split in segments of segmentLength samples (power of two) with 50% overlap.
+ * Every segment has its mean removed and is multiplied with a Hann window before the FFT.
+ * The power of all segments is averaged, the result is the RMS amplitude per frequency bin.
+ *
+ * Segments are real, so two segments are transformed with a single complex FFT.
+ * The FFT is an iterative radix-2 FFT with a precalculated twiddle table.
+ * */
+class Spectrum
+{
+
+public:
+
+    typedef struct
+    {
+        bool bValid;
+        double sampleRate; // in Hz
+        qint32 segmentLength;
+        qint32 segmentCount;
+        QVector<double> frequencies; // in Hz
+        QVector<double> amplitudes; // RMS
+
+    } Result;
+
+    static Result calculate(const QVector<double> &samples, double sampleRate, qint32 segmentLength, const QAtomicInt * pGeneration = NULL, qint32 generation = 0);
+
+    static qint32 segmentLength(qint32 sampleCount, qint32 maxSegmentLength);
+
+private:
+
+    typedef struct
+    {
+        qint32 length;
+        QVector<qint32> bitReverse;
+        QVector<double> cosTable;
+        QVector<double> sinTable;
+
+    } FftPlan;
+
+    static FftPlan createPlan(qint32 length);
+    static void transform(const FftPlan &plan, double * pReal, double * pImag);
+
+    static void loadSegment(const double * pSamples, const QVector<double> &window, qint32 length, double * pDst);
+
+};
+
+#endif // SPECTRUM_H
@@ -12,6 +12,7 @@ DataFileParser::DataFileParser(ParserModel *pParserModel)
     _pParserModel = pParserModel;
     _fileContentsEnd = 0;
     _fileEndPos = 0;
+    _unchangedRowCount = 0;
 
     _dateParseRegex.setPattern(_cPattern);
     _dateParseRegex.optimize();
@@ -23,12 +24,7 @@ DataFileParser::~DataFileParser()
 
 bool DataFileParser::forceProcessDataFile()
 {
-    _dataLabels.clear();
-    _dataRows.clear();
-
-    _fileEndPos = 0;
-    _fileContentsEnd = 0;
-    _fileContents.clear();
+    clearData();
 
     return processDataFile();
 }
@@ -37,6 +33,9 @@ bool DataFileParser::processDataFile()
 {
     bool bRet = true;
 
+    // Rows that were read before are kept, unless the file is rewritten
+    _unchangedRowCount = _dataRows.isEmpty() ? 0 : _dataRows[0].size();
+
     // Load data file
     bRet = loadDataFile();
 
@@ -93,7 +92,10 @@ bool DataFileParser::processDataFile()
         if (_pParserModel->stmStudioCorrection())
         {
             qDebug() << "Start correction";
-            correctStmStudioData();
+
+            // Last point of previous read has a right neighbour now, so it can change
+            _unchangedRowCount = qMax(_unchangedRowCount - 1, 0);
+            correctStmStudioData(_unchangedRowCount);
         }
     }
 
@@ -115,6 +117,28 @@ QList<double> DataFileParser::timeRow()
     return _timeRow;
 }
 
+/*!
+ * Number of rows at the start of dataRows() that didn't change during the last processDataFile,
+ * all rows after them are new. Zero when the file was read from the start.
+ */
+qint32 DataFileParser::unchangedRowCount()
+{
+    return _unchangedRowCount;
+}
+
+void DataFileParser::clearData()
+{
+    _dataLabels.clear();
+    _dataRows.clear();
+
+    _fileEndPos = 0;
+    _fileTail.clear();
+    _fileContentsEnd = 0;
+    _fileContents.clear();
+
+    _unchangedRowCount = 0;
+}
+
 bool DataFileParser::readData()
 {
     bool bRet = true;
@@ -217,6 +241,12 @@ bool DataFileParser::loadDataFile()
     /* If we can't open it, let's show an error message. */
     if (file.open(QIODevice::ReadOnly | QIODevice::Text))
     {
+        // Already read data has been replaced: read complete file again
+        if (isFileRewritten(&file))
+        {
+            clearData();
+        }
+
         // Go to last read position in datafile
         file.seek(_fileEndPos);
 
@@ -236,6 +266,10 @@ bool DataFileParser::loadDataFile()
         if (file.atEnd())
         {
             _fileEndPos = file.pos();
+
+            const qint64 tailSize = qMin(_fileEndPos, static_cast<qint64>(_cFileTailSize));
+            file.seek(_fileEndPos - tailSize);
+            _fileTail = file.read(tailSize);
         }
         else
         {
@@ -252,6 +286,27 @@ bool DataFileParser::loadDataFile()
     return bRet;
 }
 
+/*!
+ * Check whether the part of the file that is already read has changed,
+ * by comparing the last read bytes
+ */
+bool DataFileParser::isFileRewritten(QFile * pFile)
+{
+    if (_fileEndPos == 0)
+    {
+        return false;
+    }
+
+    if (pFile->size() < _fileEndPos)
+    {
+        return true;
+    }
+
+    pFile->seek(_fileEndPos - _fileTail.size());
+
+    return pFile->read(_fileTail.size()) != _fileTail;
+}
+
 bool DataFileParser::readLabels()
 {
    bool bRet = true;
@@ -382,7 +437,10 @@ qint64 DataFileParser::parseDateTime(QString rawData, bool *bOk)
 
 }
 
-void DataFileParser::correctStmStudioData(void)
+/*!
+ * Correct corrupted samples, points before \a firstPoint are already corrected
+ */
+void DataFileParser::correctStmStudioData(qint32 firstPoint)
 {
     for (qint32 idx = 0; idx < _dataRows.size(); idx++)
     {
@@ -390,7 +448,7 @@ void DataFileParser::correctStmStudioData(void)
         if (_dataRows[idx].size() > 3)
         {
             /* Skip first and last point */
-            for (int32_t pointIdx = 1; pointIdx < _dataRows[idx].size() - 1; pointIdx++)
+            for (int32_t pointIdx = qMax(firstPoint, 1); pointIdx < _dataRows[idx].size() - 1; pointIdx++)
             {
                 const int32_t leftPoint = _dataRows[idx][pointIdx - 1];
                 const int32_t refPoint = _dataRows[idx][pointIdx];
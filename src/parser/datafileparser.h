@@ -22,16 +22,19 @@ public:
     QList<QList<double> > & dataRows();
     QStringList & dataLabels();
     QList<double> timeRow();
+    qint32 unchangedRowCount();
 
 private:
 
+    void clearData();
     bool readData();
     bool loadDataFile();
+    bool isFileRewritten(QFile * pFile);
     bool readLabels();
     bool readLineFromFile(QFile *file, QString *pLine);
     bool isCommentLine(QString line);
     qint64 parseDateTime(QString rawData, bool * bOk);
-    void correctStmStudioData(void);
+    void correctStmStudioData(qint32 firstPoint);
     bool isNibbleCorrupt(quint16 ref, quint16 compare);
 
     ParserModel * _pParserModel;
@@ -39,6 +42,8 @@ private:
     QStringList _fileContents;
     int _fileContentsEnd; // Index of last parsed line in _fileContents
     qint64 _fileEndPos; // Last position in datafile
+    QByteArray _fileTail; // Last read bytes before _fileEndPos, to detect a rewritten file
+    qint32 _unchangedRowCount; // Rows that are the same as before the last processDataFile
     qint32 _expectedFields;
 
     QList<QList<double> > _dataRows;
@@ -48,6 +53,7 @@ private:
     QRegularExpression _dateParseRegex;
 
     static const QString _cPattern;
+    static const qint32 _cFileTailSize = 256;
 
 };
 
@@ -29,6 +29,24 @@ public:
         }
     }
 
+    /* Quote field of csv file when it contains the separator, a quote or a line break (RFC 4180) */
+    static QString csvField(const QString &field, QChar separator)
+    {
+        if (
+            field.contains(separator)
+            || field.contains('"')
+            || field.contains('\n')
+            || field.contains('\r')
+            )
+        {
+            return QString("\"%1\"").arg(QString(field).replace("\"", "\"\""));
+        }
+        else
+        {
+            return field;
+        }
+    }
+
     static void showError(QString text)
     {
         QMessageBox msgBox;